@@ -71,7 +71,8 @@ public:
 	/// Apply / undo the action.
 	/*!
 	 * Each function modifies domain state and then notifies presentation model about important
-	 * events occured. Important events are addition or deletion of objects.
+	 * events occured. Important events are addition or deletion of objects, and changes of
+	 * polygon geometry.
 	 *
 	 * \param polygons           The domain state.
 	 * \param presentationModel  Presentation model.
@@ -101,7 +102,8 @@ protected:
 	 * \param polygons  The domain state.
 	 *
 	 * \return List of important events (changes) in domain state.
-	 *         Important events are addition or deletion of objects.
+	 *         Important events are addition or deletion of objects, and changes of
+	 *         polygon geometry.
 	 *
 	 * Must provide strong exception guarantee.
 	 */
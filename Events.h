@@ -11,7 +11,12 @@ class Event
 {
 public:
 	enum Object { Polygon, Vertex } object;
-	enum Action { Added, Deleted } action;
+	/// Deleted events refer to indices before the action, Added and Modified - after it.
+	enum Action {
+		Added,
+		Deleted,
+		Modified   ///< Geometry of polygon changed in place (e.g. moved). Only for Polygon object.
+	} action;
 	UINT polygonIdx;
 	UINT vertexIdx;   ///< Used only if object == Polygon.
 
@@ -20,7 +25,7 @@ public:
 		: object(object), action(action), polygonIdx(polygonIdx), vertexIdx(vertexIdx)
 	{
 		ENSURE(object == Polygon && vertexIdx == UINT_MAX  ||
-		       object == Vertex && vertexIdx != UINT_MAX);
+		       object == Vertex && vertexIdx != UINT_MAX && action != Modified);
 	}
 };
 
@@ -36,10 +41,15 @@ public:
 class EventList
 {
 public:
+	typedef std::vector<Event>::const_iterator const_iterator;
+
 	EventList() _NOEXCEPT {}
 	EventList(std::vector<Event> &&events) _NOEXCEPT { this->events.swap(events); }
 	EventList(EventList &&r) _NOEXCEPT { events.swap(r.events); }
 
+	const_iterator begin() const { return events.begin(); }
+	const_iterator end()   const { return events.end(); }
+
 
 	/// Get number of added polygons.
 	//
@@ -79,6 +89,32 @@ public:
 		       events.front().polygonIdx == polygonIdx && events.front().vertexIdx == vertexIdx;
 	}
 
+	/// Test if vertices were added to or deleted from given polygon.
+	//
+	bool verticesChanged(UINT polygonIdx) const {
+		return std::find_if(events.begin(), events.end(), [polygonIdx](Event const &e){ return
+		                    e.object == Event::Vertex && e.polygonIdx == polygonIdx;}) != events.end();
+	}
+
+	/// Get index which given vertex has after vertex events.
+	/*!
+	 * \return UINT_MAX if the vertex was deleted.
+	 */
+	UINT vertexIdxAfter(UINT polygonIdx, UINT vertexIdx) const {
+		for ( Event const &e : events ) {
+			if ( e.object != Event::Vertex || e.polygonIdx != polygonIdx )
+				continue;
+
+			if ( e.action == Event::Added && e.vertexIdx <= vertexIdx )
+				++vertexIdx;
+			else if ( e.action == Event::Deleted && e.vertexIdx < vertexIdx )
+				--vertexIdx;
+			else if ( e.action == Event::Deleted && e.vertexIdx == vertexIdx )
+				return UINT_MAX;
+		}
+		return vertexIdx;
+	}
+
 	/// Get first added polygon event.
 	/*!
 	 * \pre At least one added polygon event must exist.
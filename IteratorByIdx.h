@@ -48,17 +48,12 @@ polygonIteratorByIdx(std::list<poly::Polygon> &polygons, UINT polygonIdx) {
 inline poly::Polygon & polygonByIdx(std::list<poly::Polygon> &polygons, UINT polygonIdx)
 { return *polygonIteratorByIdx(polygons, polygonIdx); }
 
-static poly::Polygon::iterator vertexIteratorByIdx(poly::Polygon &polygon, UINT vertexIdx) {
-	ENSURE(vertexIdx <= polygon.numVertices());
-	return next(polygon.begin(), vertexIdx);
-}
-
 inline poly::Polygon::const_iterator
 vertexIteratorByIdx(poly::Polygon const &polygon, UINT vertexIdx) {
 	ENSURE(vertexIdx <= polygon.numVertices());
 	return next(polygon.begin(), vertexIdx);
 }
 
-inline poly::Polygon::iterator
+inline poly::Polygon::const_iterator
 vertexIteratorByIdx(std::list<poly::Polygon> &polygons, UINT polygonIdx, UINT vertexIdx)
 { return vertexIteratorByIdx(polygonByIdx(polygons, polygonIdx), vertexIdx); }
@@ -1,18 +1,24 @@
 #include "Boolean.h"
 
 #include "Functions.h"
-
-#include "../Lib/Iterators.h"
+#include "EdgeIntersections.h"
+#include "Kernel.h"
+#include "RTree.h"
 
 #include <algorithm>
-#include <memory>
 #include <cassert>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <thread>
 
 #include <iomanip>
 
 
 
-#define ENABLE_TRACE
+#ifdef _DEBUG
+#  define ENABLE_TRACE
+#endif
 #ifdef ENABLE_TRACE
 #  include <windows.h>
 #  include <sstream>
@@ -33,7 +39,7 @@
  * http://www.complex-a5.ru/polyboolean/downloads/polybool_eng.pdf.
  *
  * The algorithm is not tied to any specific method for finding intersections. Here the
- * brute force is used.
+ * sweep line is used by default, brute force can be selected with setIntersectionMethod().
  *
  * Original algorithm can handle degeneracies and holes. This implementation does not.
  *
@@ -54,12 +60,20 @@ using namespace std;
  * VertEdge                  ve             see below
  * Cross vertex descriptor   xvd            see original paper 
  * Cross polygon             xp             Original polygon with added cross vertices.
- *                                            It has format vector<VertEdge>.
+ *                                            It is a cyclic list of VertEdges linked by
+ *                                            indices, see CrossPolygons.
  */
 
 
 
-struct XVD;
+/// Index of VertEdge or XVD in CrossPolygons.
+typedef unsigned Idx;
+
+static Idx const NoIdx = ~0u;
+
+/// Each crossing has two cross vertices, one per cross polygon, and each of them has
+/// descriptors for previous and next edges.
+static Idx const XvdsPerCrossing = 4;
 
 
 
@@ -69,9 +83,12 @@ struct VertEdge
 {
 	Point const vertex;
 
+	Idx prev, next;       ///< Neighbour vertices in cross polygon.
+	unsigned char xp;     ///< Cross polygon the vertex belongs to.
+
 	// The following is for cross vertices
-	shared_ptr<list<XVD>> xvdList;
-	list<XVD>::iterator xvdPrev, xvdNext;
+	Idx xvdBegin;         ///< First XVD of the crossing, NoIdx for usual vertex.
+	Idx xvdPrev, xvdNext;
 
 	enum EdgeLabel { Inside, Outside };
 	EdgeLabel edgeLabel;
@@ -79,20 +96,18 @@ struct VertEdge
 	bool edgeMark;
 
 //
-	/// Construct usual vertex
-	VertEdge(Point const &vertex)
+	/// Construct usual vertex if xvdBegin is NoIdx, cross vertex otherwise
+	VertEdge(Point const &vertex, unsigned char xp, Idx xvdBegin = NoIdx)
 		: vertex(vertex)
-		, edgeMark(false)
-	{}
-	/// Construct cross vertex
-	VertEdge(Point const &vertex,
-	         shared_ptr<list<XVD>> const &xvdList)
-		: vertex(vertex)
-		, xvdList(xvdList)
+		, prev(NoIdx), next(NoIdx)
+		, xp(xp)
+		, xvdBegin(xvdBegin)
+		, xvdPrev(NoIdx), xvdNext(NoIdx)
+		, edgeLabel(Outside)
 		, edgeMark(false)
 	{}
 
-	bool isCrossVertex() const { return (bool)xvdList; }
+	bool isCrossVertex() const { return xvdBegin != NoIdx; }
 };
 
 
@@ -101,20 +116,36 @@ struct VertEdge
 //
 struct XVD
 {
-	list<VertEdge> &xp;
-	list<VertEdge>::iterator ve;
+	Idx ve;
 
 	enum Order { Prev, Next } order;
 	
-	double polarAngle;
+	Point end;   ///< Other end of the edge, defines direction from the crossing.
+};
 
-//
-	XVD(list<VertEdge> &xp,
-	    list<VertEdge>::iterator ve,
-	    Order order,
-	    double polarAngle)
-		: xp(xp), ve(ve), order(order), polarAngle(polarAngle)
-	{}
+
+
+enum CrossPolygonIdx { Xp1, Xp2 };
+
+/// Both cross polygons of one boolean operation.
+/*!
+ * All VertEdges live in one vector and refer to each other by indices, XVDs of each crossing
+ * occupy XvdsPerCrossing consecutive elements of another vector. Storage is reserved once
+ * and freed with the object.
+ *
+ * Original vertices of each polygon are stored first, in order. Cross vertices are appended
+ * after them and linked in between, so order of vertices in cross polygon is given by
+ * prev and next indices only.
+ */
+struct CrossPolygons
+{
+	vector<VertEdge> ves;
+	vector<XVD> xvds;
+
+	Idx origBegin[2], origEnd[2];   ///< Ranges of original vertices of Xp1 and Xp2.
+
+	VertEdge       & operator[](Idx ve)       { return ves[ve]; }
+	VertEdge const & operator[](Idx ve) const { return ves[ve]; }
 };
 
 
@@ -124,13 +155,11 @@ wostream & operator<<(wostream &s, Point const &p)
 { return s << setprecision(4) << "(" << p.x << ", " << p.y << ")"; }
 
 
-static list<VertEdge> const *_xp1Ptr;
-
 wostream & operator<<(wostream &s, VertEdge const &ve)
 {
 	s << ve.vertex;
 	if ( ve.isCrossVertex() )
-		s << ", " << (&ve.xvdNext->xp == _xp1Ptr ? "A" : "B") << ", cross";
+		s << ", " << (ve.xp == Xp1 ? "A" : "B") << ", cross";
 	s << ", " << (ve.edgeLabel == VertEdge::Inside ? "inside" : "outside");
 	if ( ve.edgeMark )
 		s << ", mark";
@@ -141,139 +170,279 @@ wostream & operator<<(wostream &s, VertEdge const &ve)
 
 
 
-/// Find intersections between tho polygons.
+static IntersectionMethod intersectionMethod = IsectMethod_Sweep;
+static unsigned intersectionThreads = 1;
+static bool convexIntersections = true;
+
+
+
+/// Append original vertices of polygon to cross polygons and link them into a cycle.
+//
+static void appendOriginalVertices(Polygon const &p, CrossPolygonIdx xp, CrossPolygons &xps)
+{
+	Idx const begin = (Idx)xps.ves.size();
+	for ( Point const &vertex : p )
+		xps.ves.emplace_back(vertex, (unsigned char)xp);
+	Idx const end = (Idx)xps.ves.size();
+
+	for ( Idx ve = begin; ve != end; ++ve ) {
+		xps[ve].prev = (ve == begin ? end : ve) - 1;
+		xps[ve].next = (ve + 1 == end ? begin : ve + 1);
+	}
+
+	xps.origBegin[xp] = begin;
+	xps.origEnd[xp] = end;
+}
+
+
+
+/// Cross vertex on original edge of cross polygon.
+//
+struct EdgeCrossing
+{
+	unsigned edge;
+	double t;    ///< Position along the edge, growing from the first endpoint.
+	Idx ve;
+
+	bool operator<(EdgeCrossing const &r) const {
+		return edge < r.edge || (edge == r.edge && (t < r.t || (t == r.t && ve < r.ve)));
+	}
+};
+
+
+
+/// Position of point along edge: offset from the first endpoint along the dominant axis.
+//
+static double edgePosition(Point const &p1, Point const &p2, Point const &pt)
+{
+	double const dx = p2.x - p1.x, dy = p2.y - p1.y;
+	if ( fabs(dx) >= fabs(dy) )
+		return dx >= 0 ? pt.x - p1.x : p1.x - pt.x;
+	return dy >= 0 ? pt.y - p1.y : p1.y - pt.y;
+}
+
+
+
+/// Link cross vertices into cross polygon in one pass.
+/*!
+ * Cross vertices of each original edge are ordered by position along it.
+ *
+ * \param crossings  Cross vertices of the polygon, in any order. Sorted on return.
+ */
+static void linkCrossVertices(CrossPolygons &xps, CrossPolygonIdx xp, vector<EdgeCrossing> &crossings)
+{
+	sort(crossings.begin(), crossings.end());
+
+	Idx const begin = xps.origBegin[xp], end = xps.origEnd[xp];
+	auto crossing = crossings.begin();
+
+	Idx last = begin;
+	auto const link = [&xps, &last](Idx ve) {
+		xps[last].next = ve;
+		xps[ve].prev = last;
+		last = ve;
+	};
+
+	for ( Idx ve = begin; ve != end; ++ve ) {
+		if ( ve != begin )
+			link(ve);
+		for ( ; crossing != crossings.end() && crossing->edge == ve - begin; ++crossing )
+			link(crossing->ve);
+	}
+
+	link(begin);
+}
+
+
+
+/// Find intersections between two polygons.
+/*!
+ * Uses linear method for two convex polygons unless disabled by setConvexIntersections(), and
+ * method set by setIntersectionMethod() otherwise.
+ */
+static vector<EdgeIntersection> findIntersections(Polygon const &p1, Polygon const &p2)
+{
+	if ( convexIntersections && p1.isConvex() && p2.isConvex() )
+		return findEdgeIntersections_Convex(p1, p2);
+
+	return intersectionMethod == IsectMethod_Sweep
+	       ? findEdgeIntersections_ParallelSweep(p1, p2, intersectionThreads)
+	       : findEdgeIntersections_BruteForce(p1, p2);
+}
+
+
+
+/// Build cross polygons from two polygons and intersections between them.
 /*!
- * Uses brute force method.
  * Does not support touching by edges and vertices.
  *
  * \pre Polygons must be counterclockwise.
  *
- * \param[in] p1    Polygon 1.
- * \param[in] p2    Polygon 2.
- * \param[out] xp1  Cross polygon 1.
- * \param[out] xp2  Cross polygon 2.
+ * \param[in] p1      Polygon 1.
+ * \param[in] p2      Polygon 2.
+ * \param[in] isects  Intersections of edges of p1 and p2.
+ * \param[out] xps    Cross polygons.
  *
  * \throw domain_error If touching be edges is detected.
  */
-static void findIntersections(Polygon const &p1, Polygon const &p2,
-                              list<VertEdge> &xp1_, list<VertEdge> &xp2_)
-{
-	// Predicate for ordering segment intersections by distance from first segment endpoint
-	class SegmentPointLess {
-	public:
-		SegmentPointLess(Point const &initialPt) : initialPt(initialPt) {}
-		bool operator()(VertEdge const &p1, VertEdge const &p2) const {
-			return distanceSqr(initialPt, p1.vertex) < distanceSqr(initialPt, p2.vertex);
-		}
-	private:
-		Point const initialPt;
-	};
+static void buildCrossPolygons(Polygon const &p1, Polygon const &p2,
+                               vector<EdgeIntersection> const &isects, CrossPolygons &xps)
+{
+	for ( EdgeIntersection const &isect : isects ) {
+		if ( isect.shape == Isect_Segment )
+			//TODO
+			throw domain_error("Touching edges are not supported");
+	}
 
 
-	list<VertEdge> xp1, xp2;
-	
-	// Iterators pointing to begins of original segments in xp2
-	vector<list<VertEdge>::iterator> xp2OrigSegBegins;
+	xps.ves.clear();
+	xps.xvds.clear();
+	xps.ves.reserve(p1.numVertices() + p2.numVertices() + 2 * isects.size());
+	xps.xvds.reserve(XvdsPerCrossing * isects.size());
 
-	for ( auto seg1 = p1.edgeBegin(); seg1 != p1.edgeEnd(); ++seg1 ) {
-		Point const &seg1Vertex1 = *seg1.vertex1Iterator();
+	appendOriginalVertices(p1, Xp1, xps);
+	appendOriginalVertices(p2, Xp2, xps);
 
-		xp1.emplace_back(seg1Vertex1);
-		auto const xp1CurSegBegin = --xp1.end();
+	// Cross vertices are appended first, and linked per original edge afterwards
+	vector<EdgeCrossing> crossings[2];
+	crossings[Xp1].reserve(isects.size());
+	crossings[Xp2].reserve(isects.size());
+	xps.xvds.resize(XvdsPerCrossing * isects.size());
 
-		
-		unsigned seg2Idx = 0;
-		for ( auto seg2 = p2.edgeBegin(); seg2 != p2.edgeEnd(); ++seg2, ++seg2Idx ) {
-			Point const &seg2Vertex1 = *seg2.vertex1Iterator();
-
-			list<VertEdge>::iterator xp2CurSegBegin;
-			
-			if ( xp2OrigSegBegins.size() == seg2Idx ) {
-				xp2.emplace_back(seg2Vertex1);
-				xp2CurSegBegin = --xp2.end();
-				xp2OrigSegBegins.push_back(xp2CurSegBegin);
-			}
-			else
-				xp2CurSegBegin = xp2OrigSegBegins.at(seg2Idx);
-			
-			Point isectP1, isectP2;
-			IntersectionShape const isectShape = intersect(*seg1, *seg2, isectP1, isectP2);
-
-			if ( isectShape == Isect_Point ) {
-				auto const xvdList = make_shared<list<XVD>>();
-
-				{
-					auto const lower =
-						lower_bound(xp1CurSegBegin, xp1.end(), isectP1, SegmentPointLess(seg1Vertex1));
-					xp1.emplace(lower,
-					            isectP1, xvdList);
-				}
-				{
-					auto const lower =
-						lower_bound(xp2CurSegBegin, xp2.end(), isectP1, SegmentPointLess(seg2Vertex1));
-					xp2.emplace(lower,
-					            isectP1, xvdList);
-				}
-			}
-			else if ( isectShape == Isect_Segment )
-				//TODO
-				throw domain_error("Touching edges are not supported");
+	Idx xvdBegin = 0;
+	for ( EdgeIntersection const &isect : isects ) {
+		unsigned const edges[2] = { isect.edge1, isect.edge2 };
+		for ( int xp = Xp1; xp <= Xp2; ++xp ) {
+			Idx const segBegin = xps.origBegin[xp] + edges[xp];
+			Idx const segEnd = (segBegin + 1 == xps.origEnd[xp] ? xps.origBegin[xp] : segBegin + 1);
+
+			Idx const ve = (Idx)xps.ves.size();
+			xps.ves.emplace_back(isect.p1, (unsigned char)xp, xvdBegin);
+
+			EdgeCrossing const crossing =
+				{ edges[xp], edgePosition(xps[segBegin].vertex, xps[segEnd].vertex, isect.p1), ve };
+			crossings[xp].push_back(crossing);
 		}
 
+		xvdBegin += XvdsPerCrossing;
 	}
 
-	swap(xp1_, xp1);
-	swap(xp2_, xp2);
+	linkCrossVertices(xps, Xp1, crossings[Xp1]);
+	linkCrossVertices(xps, Xp2, crossings[Xp2]);
 }
 
 
 
-/// Insert XVD in list preserving sorting
-//
-static list<XVD>::iterator insertSorted(list<XVD> &xvdList, XVD const &xvd)
+void setIntersectionMethod(IntersectionMethod method)
+{ intersectionMethod = method; }
+
+
+IntersectionMethod getIntersectionMethod()
+{ return intersectionMethod; }
+
+
+void setIntersectionThreads(unsigned threads)
+{ intersectionThreads = threads; }
+
+
+unsigned getIntersectionThreads()
+{ return intersectionThreads; }
+
+
+void setConvexIntersections(bool enabled)
+{ convexIntersections = enabled; }
+
+
+bool getConvexIntersections()
+{ return convexIntersections; }
+
+
+
+/// Quadrant of direction from center to point: 0 for [0, pi/2), 1 for [pi/2, pi) and so on.
+/*! Exact, since subtraction does not change sign. Coincident points precede any direction.
+ */
+static int quadrant(Point const &center, Point const &p)
 {
-	auto const lower = lower_bound(xvdList.begin(), xvdList.end(), xvd,
-			[](XVD const &xvd1, XVD const &xvd2){
-				return xvd1.polarAngle < xvd2.polarAngle;
-			});
-	return xvdList.insert(lower, xvd);
+	double const dx = p.x - center.x, dy = p.y - center.y;
+	if ( dx > 0 && dy >= 0 ) return 0;
+	if ( dx <= 0 && dy > 0 ) return 1;
+	if ( dx < 0 && dy <= 0 ) return 2;
+	if ( dx >= 0 && dy < 0 ) return 3;
+	return -1;
 }
 
 
 
-/// Fill connectivity lists from the given cross polygon's side.
+/// Compare polar angles of directions from center to points, exactly.
 //
-static void fillConnectivityLists(list<VertEdge> &xp)
+static bool angleLess(Point const &center, Point const &p1, Point const &p2)
+{
+	int const q1 = quadrant(center, p1), q2 = quadrant(center, p2);
+	if ( q1 != q2 )
+		return q1 < q2;
+	return q1 >= 0 && predicates::crossSign(center, p1, center, p2) > 0;
+}
+
+
+
+/// Fill connectivity lists of all crossings.
+/*!
+ * XVDs of each crossing are sorted by polar angle, ties keep the order.
+ */
+static void fillConnectivityLists(CrossPolygons &xps)
 {
-	for ( auto ve = xp.begin(); ve != xp.end(); ++ve ) {
-		if ( ! ve->isCrossVertex() )
+	for ( Idx ve = 0; ve != xps.ves.size(); ++ve ) {
+		VertEdge const &v = xps[ve];
+		if ( ! v.isCrossVertex() )
 			continue;
-		
-		auto const vePrev = prev_cyclic(ve, xp);
-		//ve->xvdList->emplace_back(&*ve, XVD::Prev,
-		//                          polarAngle(Vector(ve->vertex, vePrev->vertex));
-		ve->xvdPrev = insertSorted(*ve->xvdList,
-		                           XVD(xp, ve,
-		                               XVD::Prev,
-															     polarAngle(Vector(ve->vertex, vePrev->vertex))));
-		
-		auto const veNext = next_cyclic(ve, xp);
-		//ve->xvdList->emplace_back(&*ve, XVD::Next,
-		//                          polarAngle(Vector(ve->vertex, veNext->vertex));
-		ve->xvdNext = insertSorted(*ve->xvdList,
-		                           XVD(xp, ve,
-		                               XVD::Next,
-		                               polarAngle(Vector(ve->vertex, veNext->vertex))));
+
+		// Cross vertex of Xp1 takes first two XVDs of the crossing, Xp2 the rest
+		Idx const xvd = v.xvdBegin + 2 * v.xp;
+
+		XVD const xvdPrev = {ve, XVD::Prev, xps[v.prev].vertex};
+		XVD const xvdNext = {ve, XVD::Next, xps[v.next].vertex};
+		xps.xvds[xvd]     = xvdPrev;
+		xps.xvds[xvd + 1] = xvdNext;
+	}
+
+	for ( Idx xvdBegin = 0; xvdBegin != xps.xvds.size(); xvdBegin += XvdsPerCrossing ) {
+		XVD *const xvds = &xps.xvds[xvdBegin];
+		Point const &center = xps[xvds[0].ve].vertex;
+
+		// Insertion sort, stable
+		for ( Idx i = 1; i != XvdsPerCrossing; ++i ) {
+			XVD const d = xvds[i];
+			Idx j = i;
+			for ( ; j > 0 && angleLess(center, d.end, xvds[j-1].end); --j )
+				xvds[j] = xvds[j-1];
+			xvds[j] = d;
+		}
+
+		for ( Idx xvd = xvdBegin; xvd != xvdBegin + XvdsPerCrossing; ++xvd ) {
+			VertEdge &ve = xps[xps.xvds[xvd].ve];
+			(xps.xvds[xvd].order == XVD::Prev ? ve.xvdPrev : ve.xvdNext) = xvd;
+		}
 	}
 }
 
 
 
-static Segment otherXVertNextEdge(VertEdge const &ve)
+/// Previous XVD of the crossing, cyclically.
+//
+static Idx prevXvd(Idx xvd, Idx xvdBegin)
 {
-	for ( XVD const &xvd : *ve.xvdList ) {
-		if ( &*xvd.ve != &ve )
-			return Segment(xvd.ve->vertex, next_cyclic(xvd.ve, xvd.xp)->vertex);
+	return xvd == xvdBegin ? xvdBegin + XvdsPerCrossing - 1 : xvd - 1;
+}
+
+
+
+static Segment otherXVertNextEdge(CrossPolygons const &xps, Idx ve)
+{
+	Idx const xvdBegin = xps[ve].xvdBegin;
+	for ( Idx xvd = xvdBegin; xvd != xvdBegin + XvdsPerCrossing; ++xvd ) {
+		Idx const other = xps.xvds[xvd].ve;
+		if ( other != ve )
+			return Segment(xps[other].vertex, xps[xps[other].next].vertex);
 	}
 
 	assert(0);
@@ -283,32 +452,48 @@ static Segment otherXVertNextEdge(VertEdge const &ve)
 
 
 /// Label edges of cross polygon
-//
-static void labelEdges(list<VertEdge> &xp)
+/*!
+ * Without crossings, all edges get the location of the polygon relative to the other one.
+ */
+static void labelEdges(CrossPolygons &xps, CrossPolygonIdx xp)
 {
 	TRACE(__FUNCTION__ << endl);
 
-	auto const firstXVert = find_if(xp.begin(), xp.end(),
-	                                [](VertEdge const &ve){ return ve.isCrossVertex(); });
+	Idx firstXVert = xps.origBegin[xp];
+	while ( ! xps[firstXVert].isCrossVertex() ) {
+		firstXVert = xps[firstXVert].next;
+		if ( firstXVert == xps.origBegin[xp] ) {
+			// No crossings, so the other polygon consists of original vertices only
+			CrossPolygonIdx const other = (xp == Xp1 ? Xp2 : Xp1);
+			vector<Point> contour;
+			for ( Idx ve = xps.origBegin[other]; ve != xps.origEnd[other]; ++ve )
+				contour.push_back(xps[ve].vertex);
+
+			VertEdge::EdgeLabel const label =
+				locatePoint(xps[firstXVert].vertex, contour) == PointLoc_Inside ? VertEdge::Inside
+				                                                                : VertEdge::Outside;
+			for ( Idx ve = xps.origBegin[xp]; ve != xps.origEnd[xp]; ++ve )
+				xps[ve].edgeLabel = label;
+			return;
+		}
+	}
 	
-	auto ve = firstXVert;
-	VertEdge::EdgeLabel lastLabel;
+	Idx ve = firstXVert;
+	VertEdge::EdgeLabel lastLabel = VertEdge::Outside;   // Set at firstXVert before use
 	do {
-		auto ve2 = next_cyclic(ve, xp);
+		Idx const ve2 = xps[ve].next;
 		
-		if ( ve->isCrossVertex() ) {
-			ve->edgeLabel = orientation(ve2->vertex, otherXVertNextEdge(*ve)) == Left ?
-						          VertEdge::Inside : VertEdge::Outside;
-			lastLabel = ve->edgeLabel;
+		if ( xps[ve].isCrossVertex() ) {
+			xps[ve].edgeLabel = orientation(xps[ve2].vertex, otherXVertNextEdge(xps, ve)) == Left ?
+			                    VertEdge::Inside : VertEdge::Outside;
+			lastLabel = xps[ve].edgeLabel;
 		}
 		else
-			ve->edgeLabel = lastLabel;
+			xps[ve].edgeLabel = lastLabel;
 
-		TRACE(*ve << endl);
+		TRACE(xps[ve] << endl);
 
-		++ve;
-		if ( ve == xp.end() )
-			ve = xp.begin();
+		ve = ve2;
 	}
 	while ( ve != firstXVert );
 }
@@ -317,13 +502,18 @@ static void labelEdges(list<VertEdge> &xp)
 
 enum Direction { Forward, Backward };
 
-typedef bool (*EdgeRule)(VertEdge const &ve, bool contourA, Direction &dir);
+/*!
+ * Edge rule is a functor
+ *     bool (VertEdge const &ve, bool contourA, Direction &dir)
+ * telling if edge belongs to result, and in which direction it is traversed. Rules are passed
+ * by type, so they are resolved at compile time.
+ */
 
 
 
-static list<VertEdge>::iterator edgeCorrespondingTo(XVD const &xvd)
+static Idx edgeCorrespondingTo(CrossPolygons const &xps, XVD const &xvd)
 {
-	return xvd.order == XVD::Next ? xvd.ve : prev_cyclic(xvd.ve, xvd.xp);
+	return xvd.order == XVD::Next ? xvd.ve : xps[xvd.ve].prev;
 }
 
 
@@ -331,113 +521,153 @@ static list<VertEdge>::iterator edgeCorrespondingTo(XVD const &xvd)
 /// Select next cross vertex and direction
 //
 template<typename EdgeRule>
-static bool jump(list<VertEdge> **xp,
+static bool jump(CrossPolygons &xps,
+                 CrossPolygonIdx &xp,
                  bool &contourA,
-                 list<VertEdge>::iterator &ve,
+                 Idx &ve,
                  Direction &dir,
                  EdgeRule edgeRule)
 {
-	TRACE(__FUNCTION__ << "((" << *ve << "), " << dir << ") {" << endl);
+	TRACE(__FUNCTION__ << "((" << xps[ve] << "), " << dir << ") {" << endl);
 
-	auto const xvdBegin = prev_cyclic((dir == Forward ? ve->xvdPrev : ve->xvdNext), *ve->xvdList);
-	auto xvd = xvdBegin;
+	Idx const crossingBegin = xps[ve].xvdBegin;
+	Idx const xvdBegin = prevXvd(dir == Forward ? xps[ve].xvdPrev : xps[ve].xvdNext, crossingBegin);
+	Idx xvd = xvdBegin;
 	do {
-		bool const contourAXvd = (*xp == &xvd->xp ? contourA : ! contourA);
-		auto const edgeXvd = edgeCorrespondingTo(*xvd);
+		XVD const &d = xps.xvds[xvd];
+		CrossPolygonIdx const xpXvd = (CrossPolygonIdx)xps[d.ve].xp;
+		bool const contourAXvd = (xp == xpXvd ? contourA : ! contourA);
+		VertEdge &edgeXvd = xps[edgeCorrespondingTo(xps, d)];
 		Direction newDir;
-		if ( ! edgeXvd->edgeMark && edgeRule(*edgeXvd, contourAXvd, newDir) ) {
-			*xp = &xvd->xp;
+		if ( ! edgeXvd.edgeMark && edgeRule(edgeXvd, contourAXvd, newDir) ) {
+			xp = xpXvd;
 			contourA = contourAXvd;
-			ve = xvd->ve;
+			ve = d.ve;
 
-			if ( xvd->order == XVD::Next && newDir == Forward ||
-			     xvd->order == XVD::Prev && newDir == Backward )
+			if ( d.order == XVD::Next && newDir == Forward ||
+			     d.order == XVD::Prev && newDir == Backward )
 			{
 				dir = newDir;
 
 				TRACE("} " << __FUNCTION__ << endl);
-				TRACE("<<" << *ve << " | " << (contourA ? "A": "B") << " | " << dir << endl);
+				TRACE("<<" << xps[ve] << " | " << (contourA ? "A": "B") << " | " << dir << endl);
 				return true;
 			}
 		}
 
-		xvd = prev_cyclic(xvd, *ve->xvdList);
+		xvd = prevXvd(xvd, crossingBegin);
 	}
 	while ( xvd != xvdBegin );
 
 	TRACE("} " << __FUNCTION__ << endl);
-	TRACE("<<" << *ve << " | " << (contourA ? "A": "B") << " | " << dir << endl);
+	TRACE("<<" << xps[ve] << " | " << (contourA ? "A": "B") << " | " << dir << endl);
 	return false;
 }
 
 
 
 template<typename EdgeRule>
-static Polygon collectContour(list<VertEdge> &xp,
-                              list<VertEdge>::iterator ve,
+static Polygon collectContour(CrossPolygons &xps,
+                              CrossPolygonIdx xp,
+                              Idx ve,
                               Direction dir,
                               EdgeRule edgeRule)
 {
-	TRACE(__FUNCTION__ << "((" << *ve << "), " << dir << ") {" << endl);
+	TRACE(__FUNCTION__ << "((" << xps[ve] << "), " << dir << ") {" << endl);
 
-	list<Point> vertices;
+	vector<Point> vertices;
 
-	list<VertEdge> *pXP = &xp;
+	CrossPolygonIdx curXp = xp;
 	bool contourA = true;
-	auto edge = (dir == Forward ? ve : prev_cyclic(ve, *pXP));
+	Idx edge = (dir == Forward ? ve : xps[ve].prev);
 	do {
-		TRACE("+ " << ve->vertex << endl);
-		vertices.push_back(ve->vertex);
+		TRACE("+ " << xps[ve].vertex << endl);
+		vertices.push_back(xps[ve].vertex);
 		
-		edge->edgeMark = true;
+		xps[edge].edgeMark = true;
 
-		ve = (dir == Forward ? next_cyclic(ve, *pXP) : prev_cyclic(ve, *pXP));
+		ve = (dir == Forward ? xps[ve].next : xps[ve].prev);
 		
-		TRACE(*ve << endl);
+		TRACE(xps[ve] << endl);
 
-		if ( ve->isCrossVertex() ) {
-			if ( ! jump(&pXP, contourA, ve, dir, edgeRule) )
+		if ( xps[ve].isCrossVertex() ) {
+			if ( ! jump(xps, curXp, contourA, ve, dir, edgeRule) )
 				break;
-			assert(contourA == (pXP == &xp));
+			assert(contourA == (curXp == xp));
 		}
 
-		edge = (dir == Forward ? ve : prev_cyclic(ve, *pXP));
+		edge = (dir == Forward ? ve : xps[ve].prev);
 	}
-	while ( ! edge->edgeMark );
+	while ( ! xps[edge].edgeMark );
 
 	TRACE("} " << __FUNCTION__ << endl);
-	return vertices;
+	return Polygon(move(vertices));
 }
 
 
 
 template<typename EdgeRule>
-static void collectContours(list<VertEdge> &xp,
+static void collectContours(CrossPolygons &xps,
+                            CrossPolygonIdx xp,
                             EdgeRule edgeRule,
                             vector<Polygon> &contours)
 {
 	TRACE(__FUNCTION__ << " {" << endl);
 
-	for ( auto ve = xp.begin(); ve != xp.end(); ++ve ) {
-		TRACE(*ve << endl);
+	Idx ve = xps.origBegin[xp];
+	do {
+		TRACE(xps[ve] << endl);
 		
 		Direction dir;
-		if ( ! ve->edgeMark && edgeRule(*ve, true, dir) ) {
-			auto veStart = (dir == Forward ? ve : next_cyclic(ve, xp));
-			Polygon contour = collectContour(xp, veStart, dir, edgeRule);
+		if ( ! xps[ve].edgeMark && edgeRule(xps[ve], true, dir) ) {
+			Idx const veStart = (dir == Forward ? ve : xps[ve].next);
+			Polygon contour = collectContour(xps, xp, veStart, dir, edgeRule);
 			contours.push_back(move(contour));
 		}
+
+		ve = xps[ve].next;
 	}
+	while ( ve != xps.origBegin[xp] );
 	
 	TRACE("} " << __FUNCTION__ << endl);
 }
 
 
 
+/// Do preparations common for all boolean operations, from building cross polygons up to
+/// labeling edges.
+/*!
+ * \pre Polygons must be counterclockwise.
+ */
+static void labelCrossPolygons(Polygon const &p1ccw, Polygon const &p2ccw,
+                               vector<EdgeIntersection> const &isects, CrossPolygons &xps)
+{
+	buildCrossPolygons(p1ccw, p2ccw, isects, xps);
+
+#ifdef ENABLE_TRACE
+	for ( CrossPolygonIdx xp : {Xp1, Xp2} ) {
+		TRACE((xp == Xp1 ? "xp1:" : "xp2:") << endl);
+		Idx ve = xps.origBegin[xp];
+		do {
+			TRACE(xps[ve].vertex << (xps[ve].isCrossVertex() ? ", cross" : "") << endl);
+			ve = xps[ve].next;
+		}
+		while ( ve != xps.origBegin[xp] );
+	}
+#endif
+	
+	fillConnectivityLists(xps);
+
+	labelEdges(xps, Xp1);
+	labelEdges(xps, Xp2);
+}
+
+
+
 /// Do preparations common for all boolean operations, up to labeling edges.
 //
 static void prepareLabeledCrossPolygons(Polygon const &p1, Polygon const &p2,
-                                        list<VertEdge> &xp1, list<VertEdge> &xp2)
+                                        CrossPolygons &xps)
 {
 	if ( ! (p1.isSimple() && p2.isSimple()) )
 		throw domain_error("Self-intersecting polygon");
@@ -445,24 +675,37 @@ static void prepareLabeledCrossPolygons(Polygon const &p1, Polygon const &p2,
 	Polygon const p1ccw = p1.toCcw();
 	Polygon const p2ccw = p2.toCcw();
 	
-	findIntersections(p1ccw, p2ccw, xp1, xp2);
+	labelCrossPolygons(p1ccw, p2ccw, findIntersections(p1ccw, p2ccw), xps);
+}
 
-	TRACE("xp1:" << endl);
-	for ( VertEdge const &ve : xp1 ) {
-		TRACE(ve.vertex << (ve.isCrossVertex() ? ", cross" : "") << endl);
-	}
-	TRACE("xp2:" << endl);
-	for ( VertEdge const &ve : xp2 ) {
-		TRACE(ve.vertex << (ve.isCrossVertex() ? ", cross" : "") << endl);
-	}
+
+/// Do preparations common for all boolean operations, up to labeling edges.
+/*! First polygon is prepared, so only the second one is checked and reoriented.
+ */
+static void prepareLabeledCrossPolygons(PreparedPolygon const &p1, Polygon const &p2,
+                                        CrossPolygons &xps)
+{
+	if ( ! p2.isSimple() )
+		throw domain_error("Self-intersecting polygon");
 	
-	_xp1Ptr = &xp1;
+	Polygon const p2ccw = p2.toCcw();
 	
-	fillConnectivityLists(xp1);
-	fillConnectivityLists(xp2);
+	labelCrossPolygons(p1.polygon(), p2ccw, p1.findEdgeIntersections(p2ccw, 0), xps);
+}
+
 
-	labelEdges(xp1);
-	labelEdges(xp2);
+/// Do preparations common for all boolean operations, up to labeling edges.
+/*! Second polygon is prepared, so only the first one is checked and reoriented.
+ */
+static void prepareLabeledCrossPolygons(Polygon const &p1, PreparedPolygon const &p2,
+                                        CrossPolygons &xps)
+{
+	if ( ! p1.isSimple() )
+		throw domain_error("Self-intersecting polygon");
+	
+	Polygon const p1ccw = p1.toCcw();
+	
+	labelCrossPolygons(p1ccw, p2.polygon(), p2.findEdgeIntersections(p1ccw, 1), xps);
 }
 
 
@@ -470,124 +713,233 @@ static void prepareLabeledCrossPolygons(Polygon const &p1, Polygon const &p2,
 /// Clear edge marks
 /*! Used for two-pass operations like partition.
  */
-static void clearEdgeMarks(list<VertEdge> &xp)
+static void clearEdgeMarks(CrossPolygons &xps)
 {
-	for ( auto &ve : xp )
+	for ( auto &ve : xps.ves )
 		ve.edgeMark = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-bool edgeRule_Add(VertEdge const &ve, bool contourA, Direction &dir)
+struct EdgeRule_Add
 {
-	TRACE(__FUNCTION__"(" << ve << ")" << endl);
+	bool operator()(VertEdge const &ve, bool /*contourA*/, Direction &dir) const
+	{
+		TRACE(__FUNCTION__"(" << ve << ")" << endl);
+
+		if ( ve.edgeLabel == VertEdge::Outside ) {
+			dir = Forward;
+			TRACE("Forward" << endl);
+			return true;
+		}
+	
+		TRACE("false" << endl);
+		return false;
+	}
+};
 
-	if ( ve.edgeLabel == VertEdge::Outside ) {
-		dir = Forward;
-		TRACE("Forward" << endl);
-		return true;
+
+
+/// Collect contours of p1 + p2 from labeled cross polygons.
+/*!
+ * Disjoint operands give two outer contours, so holes are told by orientation.
+ *
+ * \param allowHoles  Return holes as clockwise contours instead of throwing.
+ *
+ * \throw range_error If result contains holes and they are not allowed.
+ */
+static void collectSum(CrossPolygons &xps, vector<Polygon> &contours, bool allowHoles = false)
+{
+	size_t const size = contours.size();
+
+	collectContours(xps, Xp1, EdgeRule_Add(), contours);
+	collectContours(xps, Xp2, EdgeRule_Add(), contours);
+
+	if ( ! allowHoles ) {
+		for ( size_t i = size; i < contours.size(); ++i )
+			if ( ! contours[i].isCcw() )
+				throw range_error("Resulting polygon contains holes");
 	}
-	
-	TRACE("false" << endl);
-	return false;
 }
 
 
 
-vector<Polygon> add(Polygon const &p1, Polygon const &p2)
+template <typename Operand1, typename Operand2>
+static vector<Polygon> doAdd(Operand1 const &p1, Operand2 const &p2)
 {
 	TRACE(__FUNCTION__ << " {" << endl);
 
-	list<VertEdge> xp1, xp2;
+	CrossPolygons xps;
 	
-	prepareLabeledCrossPolygons(p1, p2, xp1, xp2);
+	prepareLabeledCrossPolygons(p1, p2, xps);
 
 	vector<Polygon> contours;
-	collectContours(xp1, &edgeRule_Add, contours);
-	collectContours(xp2, &edgeRule_Add, contours);
-
-	if ( contours.size() > 1 )
-		throw range_error("Resulting polygon contains holes");
+	collectSum(xps, contours);
 	
 	TRACE("} " << __FUNCTION__ << endl);
 	return contours;
 }
 
+
+vector<Polygon> add(Polygon const &p1, Polygon const &p2)
+{ return doAdd(p1, p2); }
+
+vector<Polygon> add(PreparedPolygon const &p1, Polygon const &p2)
+{ return doAdd(p1, p2); }
+
+vector<Polygon> add(Polygon const &p1, PreparedPolygon const &p2)
+{ return doAdd(p1, p2); }
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-bool edgeRule_Intersect(VertEdge const &ve, bool contourA, Direction &dir)
+struct EdgeRule_Intersect
 {
-	TRACE(__FUNCTION__"(" << ve << ")" << endl);
-
-	if ( ve.edgeLabel == VertEdge::Inside ) {
-		dir = Forward;
-		TRACE("Forward" << endl);
-		return true;
-	}
+	bool operator()(VertEdge const &ve, bool /*contourA*/, Direction &dir) const
+	{
+		TRACE(__FUNCTION__"(" << ve << ")" << endl);
+
+		if ( ve.edgeLabel == VertEdge::Inside ) {
+			dir = Forward;
+			TRACE("Forward" << endl);
+			return true;
+		}
 	
-	TRACE("false" << endl);
-	return false;
+		TRACE("false" << endl);
+		return false;
+	}
+};
+
+
+
+/// Collect contours of p1 & p2 from labeled cross polygons.
+//
+static void collectIntersection(CrossPolygons &xps, vector<Polygon> &contours)
+{
+	collectContours(xps, Xp1, EdgeRule_Intersect(), contours);
+	collectContours(xps, Xp2, EdgeRule_Intersect(), contours);
 }
 
 
 
-vector<Polygon> intersect(Polygon const &p1, Polygon const &p2)
+template <typename Operand1, typename Operand2>
+static vector<Polygon> doIntersect(Operand1 const &p1, Operand2 const &p2)
 {
 	TRACE(__FUNCTION__ << " {" << endl);
 
-	list<VertEdge> xp1, xp2;
+	CrossPolygons xps;
 	
-	prepareLabeledCrossPolygons(p1, p2, xp1, xp2);
+	prepareLabeledCrossPolygons(p1, p2, xps);
 
 	vector<Polygon> contours;
-	collectContours(xp1, &edgeRule_Intersect, contours);
-	collectContours(xp2, &edgeRule_Intersect, contours);
+	collectIntersection(xps, contours);
 	
 	TRACE("} " << __FUNCTION__ << endl);
 	return contours;
 }
 
+
+vector<Polygon> intersect(Polygon const &p1, Polygon const &p2)
+{ return doIntersect(p1, p2); }
+
+vector<Polygon> intersect(PreparedPolygon const &p1, Polygon const &p2)
+{ return doIntersect(p1, p2); }
+
+vector<Polygon> intersect(Polygon const &p1, PreparedPolygon const &p2)
+{ return doIntersect(p1, p2); }
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-bool edgeRule_Subtract(VertEdge const &ve, bool contourA, Direction &dir)
+struct EdgeRule_Subtract
 {
-	TRACE(__FUNCTION__"(" << ve << ")" << endl);
+	bool operator()(VertEdge const &ve, bool contourA, Direction &dir) const
+	{
+		TRACE(__FUNCTION__"(" << ve << ")" << endl);
+
+		if ( contourA && ve.edgeLabel == VertEdge::Outside ) {
+			dir = Forward;
+			TRACE("Forward" << endl);
+			return true;
+		}
+		else if ( ! contourA && ve.edgeLabel == VertEdge::Inside ) {
+			dir = Backward;
+			TRACE("Backward" << endl);
+			return true;
+		}
 
-	if ( contourA && ve.edgeLabel == VertEdge::Outside ) {
-		dir = Forward;
-		TRACE("Forward" << endl);
-		return true;
+		TRACE("false" << endl);
+		return false;
 	}
-	else if ( ! contourA && ve.edgeLabel == VertEdge::Inside ) {
-		dir = Backward;
-		TRACE("Backward" << endl);
-		return true;
+};
+
+
+
+/// EdgeRule_Subtract for contours started on subtrahend.
+//
+struct EdgeRule_SubtractFromOther
+{
+	bool operator()(VertEdge const &ve, bool contourA, Direction &dir) const
+	{
+		return EdgeRule_Subtract()(ve, ! contourA, dir);
 	}
+};
 
-	TRACE("false" << endl);
-	return false;
+
+
+/// Collect contours of difference from labeled cross polygons.
+/*!
+ * Contours crossing subtrahend are all reached from minuend. The only contour which is not
+ * is subtrahend lying inside minuend without crossings, which is a hole.
+ *
+ * \param xp          Minuend: Xp1 for p1 - p2, Xp2 for p2 - p1.
+ * \param allowHoles  Return such hole as clockwise contour instead of throwing.
+ *
+ * \throw range_error If result contains hole and it is not allowed.
+ */
+static void collectDifference(CrossPolygons &xps, CrossPolygonIdx xp, vector<Polygon> &contours,
+                              bool allowHoles = false)
+{
+	CrossPolygonIdx const other = (xp == Xp1 ? Xp2 : Xp1);
+
+	if ( ! allowHoles && xps.xvds.empty() && xps[xps.origBegin[other]].edgeLabel == VertEdge::Inside )
+		throw range_error("Resulting polygon contains holes");
+
+	collectContours(xps, xp, EdgeRule_Subtract(), contours);
+
+	if ( allowHoles )
+		collectContours(xps, other, EdgeRule_SubtractFromOther(), contours);
 }
 
 
 
-vector<Polygon> subtract(Polygon const &p1, Polygon const &p2)
+template <typename Operand1, typename Operand2>
+static vector<Polygon> doSubtract(Operand1 const &p1, Operand2 const &p2)
 {
 	TRACE(__FUNCTION__ << " {" << endl);
 
-	list<VertEdge> xp1, xp2;
+	CrossPolygons xps;
 	
-	prepareLabeledCrossPolygons(p1, p2, xp1, xp2);
+	prepareLabeledCrossPolygons(p1, p2, xps);
 
 	vector<Polygon> contours;
-	collectContours(xp1, &edgeRule_Subtract, contours);
+	collectDifference(xps, Xp1, contours);
 	
 	TRACE("} " << __FUNCTION__ << endl);
 	return contours;
 }
 
+
+vector<Polygon> subtract(Polygon const &p1, Polygon const &p2)
+{ return doSubtract(p1, p2); }
+
+vector<Polygon> subtract(PreparedPolygon const &p1, Polygon const &p2)
+{ return doSubtract(p1, p2); }
+
+vector<Polygon> subtract(Polygon const &p1, PreparedPolygon const &p2)
+{ return doSubtract(p1, p2); }
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -615,48 +967,321 @@ vector<Polygon> subtract(Polygon const &p1, Polygon const &p2)
 
 
 
-vector<Polygon> xor(Polygon const &p1, Polygon const &p2)
+template <typename Operand1, typename Operand2>
+static vector<Polygon> doXor(Operand1 const &p1, Operand2 const &p2)
 {
 	TRACE(__FUNCTION__ << " {" << endl);
 
-	list<VertEdge> xp1, xp2;
+	CrossPolygons xps;
 	
-	prepareLabeledCrossPolygons(p1, p2, xp1, xp2);
+	prepareLabeledCrossPolygons(p1, p2, xps);
 
 	vector<Polygon> contours;
-	collectContours(xp1, &edgeRule_Subtract, contours);
-	collectContours(xp2, &edgeRule_Subtract, contours);
+	collectDifference(xps, Xp1, contours);
+	collectDifference(xps, Xp2, contours);
 	
 	TRACE("} " << __FUNCTION__ << endl);
 	return contours;
 }
 
+
+vector<Polygon> xor(Polygon const &p1, Polygon const &p2)
+{ return doXor(p1, p2); }
+
+vector<Polygon> xor(PreparedPolygon const &p1, Polygon const &p2)
+{ return doXor(p1, p2); }
+
+vector<Polygon> xor(Polygon const &p1, PreparedPolygon const &p2)
+{ return doXor(p1, p2); }
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-vector<Polygon> partition(Polygon const &p1, Polygon const &p2)
+template <typename Operand1, typename Operand2>
+static vector<Polygon> doPartition(Operand1 const &p1, Operand2 const &p2)
 {
 	TRACE(__FUNCTION__ << " {" << endl);
 
-	list<VertEdge> xp1, xp2;
+	CrossPolygons xps;
 	
-	prepareLabeledCrossPolygons(p1, p2, xp1, xp2);
+	prepareLabeledCrossPolygons(p1, p2, xps);
 
 	vector<Polygon> contours;
 	
 	// Partition is a combination of (p1 & p2) and (p1 - p2)
 	
-	collectContours(xp1, &edgeRule_Intersect, contours);
+	collectIntersection(xps, contours);
 
-	clearEdgeMarks(xp1);
-	clearEdgeMarks(xp2);
+	clearEdgeMarks(xps);
 	
-	collectContours(xp1, &edgeRule_Subtract, contours);
+	collectDifference(xps, Xp1, contours);
 
 	TRACE("} " << __FUNCTION__ << endl);
 	return contours;
 }
 
 
+vector<Polygon> partition(Polygon const &p1, Polygon const &p2)
+{ return doPartition(p1, p2); }
+
+vector<Polygon> partition(PreparedPolygon const &p1, Polygon const &p2)
+{ return doPartition(p1, p2); }
+
+vector<Polygon> partition(Polygon const &p1, PreparedPolygon const &p2)
+{ return doPartition(p1, p2); }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/// Collect requested results from labeled cross polygons.
+/*!
+ * \param allowHoles  Return holes as clockwise contours. Otherwise results with holes throw.
+ */
+static void collectResults(CrossPolygons &xps, unsigned operations, bool allowHoles,
+                           BooleanResults &rv)
+{
+	// Each result is collected in a separate pass over the same cross polygons
+	bool marked = false;
+	auto const startPass = [&]() {
+		if ( marked )
+			clearEdgeMarks(xps);
+		marked = true;
+	};
+
+	if ( operations & BoolOp_Add ) {
+		startPass();
+		collectSum(xps, rv.sum, allowHoles);
+	}
+	if ( operations & BoolOp_Intersect ) {
+		startPass();
+		collectIntersection(xps, rv.intersection);
+	}
+	if ( operations & BoolOp_Subtract12 ) {
+		startPass();
+		collectDifference(xps, Xp1, rv.difference12, allowHoles);
+	}
+	if ( operations & BoolOp_Subtract21 ) {
+		startPass();
+		collectDifference(xps, Xp2, rv.difference21, allowHoles);
+	}
+	if ( operations & BoolOp_Xor ) {
+		startPass();
+		collectDifference(xps, Xp1, rv.symDifference, allowHoles);
+		collectDifference(xps, Xp2, rv.symDifference, allowHoles);
+	}
+}
+
+
+
+template <typename Operand1, typename Operand2>
+static BooleanResults doEvaluateBoolean(Operand1 const &p1, Operand2 const &p2, unsigned operations)
+{
+	TRACE(__FUNCTION__ << " {" << endl);
+
+	CrossPolygons xps;
+	
+	prepareLabeledCrossPolygons(p1, p2, xps);
+
+	BooleanResults rv;
+	collectResults(xps, operations, false, rv);
+
+	TRACE("} " << __FUNCTION__ << endl);
+	return rv;
+}
+
+
+BooleanResults evaluateBoolean(Polygon const &p1, Polygon const &p2, unsigned operations)
+{ return doEvaluateBoolean(p1, p2, operations); }
+
+BooleanResults evaluateBoolean(PreparedPolygon const &p1, Polygon const &p2, unsigned operations)
+{ return doEvaluateBoolean(p1, p2, operations); }
+
+BooleanResults evaluateBoolean(Polygon const &p1, PreparedPolygon const &p2, unsigned operations)
+{ return doEvaluateBoolean(p1, p2, operations); }
+
+
+
+BooleanRingResults assembleRings(BooleanResults &&results)
+{
+	BooleanRingResults rv;
+	rv.sum           = assembleRings(move(results.sum));
+	rv.intersection  = assembleRings(move(results.intersection));
+	rv.difference12  = assembleRings(move(results.difference12));
+	rv.difference21  = assembleRings(move(results.difference21));
+	rv.symDifference = assembleRings(move(results.symDifference));
+	return rv;
+}
+
+
+
+template <typename Operand1, typename Operand2>
+static BooleanRingResults doEvaluateBoolean_Rings(Operand1 const &p1, Operand2 const &p2,
+                                                  unsigned operations)
+{
+	TRACE(__FUNCTION__ << " {" << endl);
+
+	CrossPolygons xps;
+	
+	prepareLabeledCrossPolygons(p1, p2, xps);
+
+	BooleanResults contours;
+	collectResults(xps, operations, true, contours);
+
+	BooleanRingResults rv = assembleRings(move(contours));
+
+	TRACE("} " << __FUNCTION__ << endl);
+	return rv;
+}
+
+
+BooleanRingResults evaluateBoolean_Rings(Polygon const &p1, Polygon const &p2, unsigned operations)
+{ return doEvaluateBoolean_Rings(p1, p2, operations); }
+
+BooleanRingResults evaluateBoolean_Rings(PreparedPolygon const &p1, Polygon const &p2,
+                                         unsigned operations)
+{ return doEvaluateBoolean_Rings(p1, p2, operations); }
+
+BooleanRingResults evaluateBoolean_Rings(Polygon const &p1, PreparedPolygon const &p2,
+                                         unsigned operations)
+{ return doEvaluateBoolean_Rings(p1, p2, operations); }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+/// Minimal number of polygons for which halves of union are computed in parallel.
+static size_t const MinParallelUnion = 64;
+
+
+
+/// Test if p1 contains p2, provided that their contours do not intersect.
+//
+static bool containsDisjoint(Polygon const &p1, Polygon const &p2)
+{
+	return p1.boundingBox().contains(p2.boundingBox()) && inside(p2[0], p1);
+}
+
+
+
+/// Unite two sets of disjoint polygons.
+/*!
+ * Polygons of b are merged into a one by one. Only polygons of a with bounding boxes touching
+ * the merged one are tested.
+ *
+ * \param[in,out] a  First set, receives the union.
+ * \param[in]     b  Second set.
+ */
+static void unite(vector<Polygon> &a, vector<Polygon> &&b)
+{
+	RTree<unsigned> index;
+	for ( unsigned i = 0; i < a.size(); ++i )
+		index.insert(a[i].boundingBox(), i);
+
+	for ( Polygon &p : b ) {
+		bool absorbed = false;
+		bool grown = true;
+		
+		while ( grown && ! absorbed ) {
+			grown = false;
+
+			vector<unsigned> candidates;
+			index.query(p.boundingBox(), [&](Rect const &, unsigned i){ candidates.push_back(i); });
+
+			for ( unsigned i : candidates ) {
+				Polygon &q = a[i];
+
+				if ( intersects(p, q) ) {
+					// Union with holes throws, so intersecting polygons give one contour
+					vector<Polygon> u = add(p, q);
+					if ( u.size() != 1 )
+						throw logic_error("Union of intersecting polygons is not one polygon");
+					p = move(u.front());
+					grown = true;
+				}
+				else if ( containsDisjoint(q, p) ) {
+					absorbed = true;
+					break;
+				}
+				else if ( ! containsDisjoint(p, q) )
+					continue;
+
+				// q is now part of p
+				index.remove(q.boundingBox(), i);
+				q = Polygon();
+
+				if ( grown )
+					break;   // Bounding box of p changed, search again
+			}
+		}
+
+		if ( ! absorbed ) {
+			index.insert(p.boundingBox(), a.size());
+			a.push_back(move(p));
+		}
+	}
+
+	a.erase(remove_if(a.begin(), a.end(), [](Polygon const &p){ return p.empty(); }), a.end());
+}
+
+
+
+/// Cascaded union of polygons in range.
+/*!
+ * \param parallelDepth  Number of upper levels of cascade where halves are united in parallel.
+ */
+static vector<Polygon> unionAll(Polygon const *const *begin, Polygon const *const *end,
+                                unsigned parallelDepth)
+{
+	if ( begin == end )
+		return vector<Polygon>();
+
+	if ( end - begin == 1 ) {
+		if ( ! (*begin)->isSimple() )
+			throw domain_error("Self-intersecting polygon");
+
+		vector<Polygon> rv;
+		rv.push_back((*begin)->toCcw());
+		return rv;
+	}
+
+	Polygon const *const *const mid = begin + (end - begin) / 2;
+	
+	vector<Polygon> left, right;
+	if ( parallelDepth > 0 && size_t(end - begin) >= MinParallelUnion ) {
+		auto leftFuture = async(launch::async, [=]{ return unionAll(begin, mid, parallelDepth - 1); });
+		right = unionAll(mid, end, parallelDepth - 1);
+		left = leftFuture.get();
+	}
+	else {
+		left  = unionAll(begin, mid, 0);
+		right = unionAll(mid, end, 0);
+	}
+
+	unite(left, move(right));
+	return left;
+}
+
+
+
+vector<Polygon> unionAll(vector<Polygon const *> polygons)
+{
+	TRACE(__FUNCTION__ << " {" << endl);
+
+	// Neighbouring polygons go to the same subtree, so intermediate results stay compact
+	sort(polygons.begin(), polygons.end(), [](Polygon const *p1, Polygon const *p2){
+		return p1->boundingBox().pMin.x + p1->boundingBox().pMax.x <
+		       p2->boundingBox().pMin.x + p2->boundingBox().pMax.x;
+	});
+
+	unsigned parallelDepth = 0;
+	for ( unsigned n = 1; n < thread::hardware_concurrency(); n *= 2 )
+		++parallelDepth;
+
+	vector<Polygon> rv = unionAll(polygons.data(), polygons.data() + polygons.size(), parallelDepth);
+
+	TRACE("} " << __FUNCTION__ << endl);
+	return rv;
+}
+
+
 
 } // namespace poly
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "MultiRingPolygon.h"
 #include "Polygon.h"
+#include "PreparedPolygon.h"
 
+#include <utility>
 #include <vector>
 
 
@@ -15,14 +18,24 @@ namespace poly {
  *
  * All operations can be passed both CW and CCW polygons.
  *
+ * For two convex polygons, intersections are found in linear time, so operations are
+ * O(n + m + k log k), where k is the number of intersections. Results are the same as for
+ * general polygons.
+ *
  * Polygons must be simple.
  *
+ * Results are simple polygons, so operations throw range_error if a result contains holes:
+ * union of polygons enclosing a gap, or difference with subtrahend lying inside minuend (also
+ * for xor and partition). See evaluateBoolean_Rings() for results with holes.
+ *
  * Not supported:
  * - touching of polygons by edges - throws exception.
  * - touching vertex to edge and vertex to vertex - produces incorrect results.
+ * Operations on integer grid support both, see SnapBoolean.h.
  */
 
 
+/// Union of p1 and p2; disjoint operands are returned as two polygons.
 std::vector<Polygon> add(Polygon const &p1, Polygon const &p2);
 
 std::vector<Polygon> intersect(Polygon const &p1, Polygon const &p2);
@@ -35,6 +48,157 @@ std::vector<Polygon> xor(Polygon const &p1, Polygon const &p2);
 /// Partition of p1 by p2.
 std::vector<Polygon> partition(Polygon const &p1, Polygon const &p2);
 
+/*!
+ * The same operations with one of operands prepared. Prepared operand is not checked and
+ * reoriented again, and intersections with it are found through its edge index.
+ * Results are the same as with unprepared operands.
+ */
+
+std::vector<Polygon> add(PreparedPolygon const &p1, Polygon const &p2);
+std::vector<Polygon> add(Polygon const &p1, PreparedPolygon const &p2);
+
+std::vector<Polygon> intersect(PreparedPolygon const &p1, Polygon const &p2);
+std::vector<Polygon> intersect(Polygon const &p1, PreparedPolygon const &p2);
+
+std::vector<Polygon> subtract(PreparedPolygon const &p1, Polygon const &p2);
+std::vector<Polygon> subtract(Polygon const &p1, PreparedPolygon const &p2);
+
+std::vector<Polygon> xor(PreparedPolygon const &p1, Polygon const &p2);
+std::vector<Polygon> xor(Polygon const &p1, PreparedPolygon const &p2);
+
+std::vector<Polygon> partition(PreparedPolygon const &p1, Polygon const &p2);
+std::vector<Polygon> partition(Polygon const &p1, PreparedPolygon const &p2);
+
+
+
+/// Operations computed by evaluateBoolean().
+//
+enum BooleanOp {
+	BoolOp_Add        = 0x01,   ///< p1 + p2
+	BoolOp_Intersect  = 0x02,   ///< p1 & p2
+	BoolOp_Subtract12 = 0x04,   ///< p1 - p2
+	BoolOp_Subtract21 = 0x08,   ///< p2 - p1
+	BoolOp_Xor        = 0x10    ///< p1 ^ p2
+};
+
+/// Results of evaluateBoolean(). Results of operations not requested are empty.
+//
+struct BooleanResults {
+	std::vector<Polygon> sum;
+	std::vector<Polygon> intersection;
+	std::vector<Polygon> difference12;
+	std::vector<Polygon> difference21;
+	std::vector<Polygon> symDifference;
+};
+
+/// Compute several boolean operations at once.
+/*!
+ * Validation, reorientation and intersection search are done once for all operations.
+ *
+ * Results describe the same regions as separate operations. p2 - p1 can differ from
+ * subtract(p2, p1) in starting vertex and order of contours.
+ *
+ * \param operations  Combination of BooleanOp flags.
+ *
+ * \throw range_error If a requested result contains holes.
+ */
+BooleanResults evaluateBoolean(Polygon const &p1, Polygon const &p2, unsigned operations);
+BooleanResults evaluateBoolean(PreparedPolygon const &p1, Polygon const &p2, unsigned operations);
+BooleanResults evaluateBoolean(Polygon const &p1, PreparedPolygon const &p2, unsigned operations);
+
+/// Results of evaluateBoolean_Rings(), as polygons with holes.
+//
+struct BooleanRingResults {
+	std::vector<MultiRingPolygon> sum;
+	std::vector<MultiRingPolygon> intersection;
+	std::vector<MultiRingPolygon> difference12;
+	std::vector<MultiRingPolygon> difference21;
+	std::vector<MultiRingPolygon> symDifference;
+};
+
+/// Compute several boolean operations at once, with results as polygons with holes.
+/*!
+ * The same as evaluateBoolean(), but results do not throw on holes, and holes of all results
+ * are assigned to their outer rings, see assembleRings().
+ */
+BooleanRingResults evaluateBoolean_Rings(Polygon const &p1, Polygon const &p2, unsigned operations);
+BooleanRingResults evaluateBoolean_Rings(PreparedPolygon const &p1, Polygon const &p2,
+                                         unsigned operations);
+BooleanRingResults evaluateBoolean_Rings(Polygon const &p1, PreparedPolygon const &p2,
+                                         unsigned operations);
+
+/// Assemble contours of each result into polygons with holes.
+//
+BooleanRingResults assembleRings(BooleanResults &&results);
+
+/// Union of any number of polygons.
+/*!
+ * Polygons are united by balanced cascade: halves of the set are united recursively, and then
+ * the two results are merged. Only polygons with touching bounding boxes are merged together.
+ * Upper levels of cascade run in parallel threads.
+ *
+ * Disjoint polygons are returned separately, and polygons contained in others are absorbed.
+ * Result polygons are counterclockwise.
+ *
+ * Polygons must not be used from other threads during the call.
+ *
+ * \throw domain_error If a polygon is self-intersecting, or polygons touch by edges.
+ * \throw range_error If union contains holes.
+ */
+std::vector<Polygon> unionAll(std::vector<Polygon const *> polygons);
+
+/// Union of polygons in range.
+/*! \see unionAll(std::vector<Polygon const *>)
+ */
+template <typename InputIterator>
+std::vector<Polygon> unionAll(InputIterator begin, InputIterator end)
+{
+	std::vector<Polygon const *> polygons;
+	for ( ; begin != end; ++begin )
+		polygons.push_back(&*begin);
+	return unionAll(std::move(polygons));
+}
+
+
+
+/// Method of finding intersections of polygon edges, used by boolean operations.
+/*!
+ * Brute force tests each pair of edges, which is O(n*m). Sweep is O((n + m + k) log(n + m)),
+ * where k is the number of intersections. Both give the same results, so brute force is kept
+ * mostly for benchmarking.
+ */
+enum IntersectionMethod { IsectMethod_BruteForce, IsectMethod_Sweep };
+
+/// Set method of finding intersections. Default is IsectMethod_Sweep.
+/*! Not thread-safe, must not be called while boolean operations run in other threads.
+ */
+void setIntersectionMethod(IntersectionMethod method);
+
+IntersectionMethod getIntersectionMethod();
+
+/// Set number of threads finding intersections by IsectMethod_Sweep. Default is 1.
+/*!
+ * 0 means hardware concurrency. Edges of large operands are always split into the same chunks,
+ * so results are bit-identical for any number of threads, see
+ * findEdgeIntersections_ParallelSweep().
+ *
+ * Not thread-safe, must not be called while boolean operations run in other threads.
+ */
+void setIntersectionThreads(unsigned threads);
+
+unsigned getIntersectionThreads();
+
+/// Set if intersections of two convex operands are found by findEdgeIntersections_Convex(),
+/// regardless of intersection method. Default is true.
+/*!
+ * Results are the same either way, so disabling is meant for tests and benchmarking.
+ *
+ * Not thread-safe, must not be called while boolean operations run in other threads.
+ */
+void setConvexIntersections(bool enabled);
+
+bool getConvexIntersections();
+
 
 
 } // namespace poly
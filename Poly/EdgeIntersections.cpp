@@ -0,0 +1,657 @@
+#include "EdgeIntersections.h"
+
+#include "Rect.h"
+#include "SegmentBatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <queue>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+namespace {
+
+
+
+/// Segment taking part in sweep.
+//
+struct SweepSegment
+{
+	Segment edge;        ///< Original edge, directed as in polygon.
+	Point left, right;   ///< Endpoints in lexicographical order.
+	unsigned owner;      ///< Index of polygon owning the edge.
+	unsigned idx;        ///< Edge index in owner polygon.
+
+//
+	SweepSegment(Segment const &edge, unsigned owner, unsigned idx)
+		: edge(edge)
+		, left (edge.p1 < edge.p2 ? edge.p1 : edge.p2)
+		, right(edge.p1 < edge.p2 ? edge.p2 : edge.p1)
+		, owner(owner)
+		, idx(idx)
+	{}
+
+	bool vertical() const { return left.x == right.x; }
+};
+
+
+
+/// Sweep line engine (Bentley-Ottmann).
+/*!
+ * Vertical sweep line moves from left to right. Points with equal x are swept from bottom
+ * to top, as if the line was slightly rotated. Status is the set of segments crossing the
+ * sweep line, ordered from bottom to top.
+ *
+ * The engine does not test segments for intersection itself. It calls given pair test for
+ * each pair of segments becoming adjacent in status, and for each pair of segments passing
+ * through the same event point. The test can schedule crossing of the pair, and then the pair
+ * is swapped in status when sweep line reaches the crossing point.
+ *
+ * \pre Segments are not of zero length.
+ */
+class Sweep
+{
+public:
+	explicit Sweep(vector<SweepSegment> &&segments);
+
+	/// Run the sweep.
+	/*!
+	 * \param test  Functor bool(unsigned s1, unsigned s2) called for pairs of segments.
+	 *              The same pair can be passed several times. Returning false stops the sweep.
+	 */
+	template<typename PairTest>
+	void run(PairTest test);
+
+	/// Schedule crossing of two segments in given point.
+	/*! Crossings in endpoints of segments and in already swept points are ignored.
+	 */
+	void scheduleCrossing(unsigned s1, unsigned s2, Point const &pt);
+
+	SweepSegment const & segment(unsigned s) const { return segments[s]; }
+
+private:
+	class StatusLess {
+	public:
+		explicit StatusLess(Sweep const *sweep) : sweep(sweep) {}
+		bool operator()(unsigned s1, unsigned s2) const { return sweep->statusLess(s1, s2); }
+	private:
+		Sweep const *sweep;
+	};
+
+	typedef set<unsigned, StatusLess> Status;
+
+	struct Endpoint {
+		Point pt;
+		unsigned s;
+		bool start;
+	};
+
+	struct Crossing {
+		Point pt;
+		unsigned s1, s2;
+
+		bool operator>(Crossing const &r) const { return r.pt < pt; }
+	};
+
+//
+	double yAtSweepLine(unsigned s) const;
+	bool statusLess(unsigned s1, unsigned s2) const;
+
+	void collectThrough(unsigned s, vector<unsigned> &through) const;
+
+	template<typename PairTest>
+	bool testNeighbours(unsigned s, PairTest &test);
+
+// Fields
+	vector<SweepSegment> const segments;
+
+	vector<Endpoint> endpoints;   ///< Sorted by point.
+	priority_queue<Crossing, vector<Crossing>, greater<Crossing>> crossings;
+
+	Point sweepPt;   ///< Current event point.
+
+	Status status;
+	vector<Status::iterator> positions;   ///< Position of segment in status.
+	vector<char> inStatus;
+	vector<char> throughSweepPt;          ///< Segment passes through current event point.
+};
+
+
+
+Sweep::Sweep(vector<SweepSegment> &&segments_)
+	: segments(move(segments_))
+	, sweepPt(0, 0)
+	, status(StatusLess(this))
+	, positions(segments.size())
+	, inStatus(segments.size(), false)
+	, throughSweepPt(segments.size(), false)
+{
+	endpoints.reserve(segments.size() * 2);
+	for ( unsigned s = 0; s < segments.size(); ++s ) {
+		Endpoint const start = {segments[s].left,  s, true};
+		Endpoint const end   = {segments[s].right, s, false};
+		endpoints.push_back(start);
+		endpoints.push_back(end);
+	}
+
+	sort(endpoints.begin(), endpoints.end(),
+	     [](Endpoint const &e1, Endpoint const &e2){ return e1.pt < e2.pt; });
+}
+
+
+
+/// Get y of segment on sweep line.
+//
+double Sweep::yAtSweepLine(unsigned s) const
+{
+	if ( throughSweepPt[s] )
+		return sweepPt.y;
+
+	SweepSegment const &seg = segments[s];
+
+	if ( seg.vertical() )
+		return min(max(sweepPt.y, seg.left.y), seg.right.y);
+
+	// Exact values in endpoints
+	if ( sweepPt.x == seg.left.x )
+		return seg.left.y;
+	if ( sweepPt.x == seg.right.x )
+		return seg.right.y;
+
+	return seg.left.y +
+	       (sweepPt.x - seg.left.x) * (seg.right.y - seg.left.y) / (seg.right.x - seg.left.x);
+}
+
+
+
+bool Sweep::statusLess(unsigned s1, unsigned s2) const
+{
+	if ( s1 == s2 )
+		return false;
+
+	double const y1 = yAtSweepLine(s1);
+	double const y2 = yAtSweepLine(s2);
+	if ( y1 != y2 )
+		return y1 < y2;
+
+	// Common point on sweep line. If it is already swept, order by slopes to the right of it,
+	// otherwise to the left.
+	int const p = predicates::crossSign(segments[s1].left, segments[s1].right,
+	                                    segments[s2].left, segments[s2].right);
+	if ( p != 0 )
+		return y1 > sweepPt.y ? p < 0 : p > 0;
+
+	return s1 < s2;
+}
+
+
+
+void Sweep::scheduleCrossing(unsigned s1, unsigned s2, Point const &crossingPt)
+{
+	SweepSegment const &seg1 = segments[s1];
+	SweepSegment const &seg2 = segments[s2];
+
+	// Crossing with vertical segment is swept when the line is at its x, even if rounded
+	// crossing point is off it
+	Point pt = crossingPt;
+	if ( seg1.vertical() )
+		pt.x = seg1.left.x;
+	else if ( seg2.vertical() )
+		pt.x = seg2.left.x;
+
+	if ( ! (sweepPt < pt) )
+		return;
+
+	if ( pt == seg1.left || pt == seg1.right || pt == seg2.left || pt == seg2.right )
+		return;
+
+	// Rounded crossing point can fall beyond right endpoint of a segment, e.g. to the right of
+	// vertical one. Such segment leaves status before, so there is nothing to swap.
+	if ( ! (pt < seg1.right && pt < seg2.right) )
+		return;
+
+	Crossing const crossing = {pt, s1, s2};
+	crossings.push(crossing);
+}
+
+
+
+/// Collect segments adjacent to given one in status and passing through event point.
+//
+void Sweep::collectThrough(unsigned s, vector<unsigned> &through) const
+{
+	for ( auto it = positions[s]; it != status.begin() && yAtSweepLine(*prev(it)) == sweepPt.y; --it )
+		through.push_back(*prev(it));
+
+	for ( auto it = next(positions[s]); it != status.end() && yAtSweepLine(*it) == sweepPt.y; ++it )
+		through.push_back(*it);
+}
+
+
+
+template<typename PairTest>
+bool Sweep::testNeighbours(unsigned s, PairTest &test)
+{
+	auto const it = positions[s];
+
+	if ( it != status.begin() && ! test(*prev(it), s) )
+		return false;
+
+	auto const itNext = next(it);
+	if ( itNext != status.end() && ! test(s, *itNext) )
+		return false;
+
+	return true;
+}
+
+
+
+template<typename PairTest>
+void Sweep::run(PairTest test)
+{
+	size_t nextEndpoint = 0;
+
+	vector<unsigned> removed, inserted, neighbours, through;
+
+	while ( nextEndpoint < endpoints.size() || ! crossings.empty() ) {
+		Point const pt =
+			crossings.empty() ||
+			(nextEndpoint < endpoints.size() && endpoints[nextEndpoint].pt < crossings.top().pt) ?
+				endpoints[nextEndpoint].pt : crossings.top().pt;
+
+		removed.clear();
+		inserted.clear();
+		neighbours.clear();
+
+		for ( ; nextEndpoint < endpoints.size() && endpoints[nextEndpoint].pt == pt; ++nextEndpoint ) {
+			Endpoint const &e = endpoints[nextEndpoint];
+			(e.start ? inserted : removed).push_back(e.s);
+		}
+
+		// Crossing segments are removed and inserted back in new order. Segments which have
+		// already left status are not inserted again.
+		for ( ; ! crossings.empty() && crossings.top().pt == pt; crossings.pop() ) {
+			Crossing const &c = crossings.top();
+			for ( unsigned s : {c.s1, c.s2} ) {
+				if ( inStatus[s] ) {
+					removed.push_back(s);
+					inserted.push_back(s);
+				}
+			}
+		}
+
+		for ( unsigned s : removed ) {
+			if ( ! inStatus[s] )
+				continue;
+
+			auto const it = positions[s];
+			if ( it != status.begin() )
+				neighbours.push_back(*prev(it));
+			if ( next(it) != status.end() )
+				neighbours.push_back(*next(it));
+
+			status.erase(it);
+			inStatus[s] = false;
+		}
+
+		sweepPt = pt;
+
+		for ( unsigned s : inserted )
+			throughSweepPt[s] = true;
+
+		for ( unsigned s : inserted ) {
+			if ( inStatus[s] )
+				continue;
+			positions[s] = status.insert(s).first;
+			inStatus[s] = true;
+		}
+
+		// All segments passing through event point intersect each other. Those not ending here
+		// are adjacent in status.
+		through = inserted;
+		for ( unsigned s : removed ) {
+			if ( segments[s].right == pt )
+				through.push_back(s);
+		}
+		for ( unsigned s : inserted )
+			collectThrough(s, through);
+		for ( unsigned s : neighbours ) {
+			if ( inStatus[s] && yAtSweepLine(s) == pt.y ) {
+				through.push_back(s);
+				collectThrough(s, through);
+			}
+		}
+		sort(through.begin(), through.end());
+		through.erase(unique(through.begin(), through.end()), through.end());
+
+		bool proceed = true;
+		for ( auto s1 = through.begin(); proceed && s1 != through.end(); ++s1 ) {
+			for ( auto s2 = s1 + 1; proceed && s2 != through.end(); ++s2 )
+				proceed = test(*s1, *s2);
+		}
+
+		for ( auto s = inserted.begin(); proceed && s != inserted.end(); ++s )
+			proceed = testNeighbours(*s, test);
+		for ( auto s = neighbours.begin(); proceed && s != neighbours.end(); ++s ) {
+			if ( inStatus[*s] )
+				proceed = testNeighbours(*s, test);
+		}
+
+		for ( unsigned s : inserted )
+			throughSweepPt[s] = false;
+
+		if ( ! proceed )
+			return;
+	}
+}
+
+
+
+/// Append non-degenerate edges of polygon to sweep segments.
+//
+void addSweepSegments(Polygon const &polygon, unsigned owner, vector<SweepSegment> &segments)
+{
+	unsigned idx = 0;
+	for ( auto edge = polygon.edgeBegin(); edge != polygon.edgeEnd(); ++edge, ++idx ) {
+		Segment const seg = *edge;
+		if ( ! (seg.p1 == seg.p2) )
+			segments.emplace_back(seg, owner, idx);
+	}
+}
+
+
+
+bool edgeIntersectionLess(EdgeIntersection const &i1, EdgeIntersection const &i2)
+{
+	return i1.edge1 < i2.edge1 || (i1.edge1 == i2.edge1 && i1.edge2 < i2.edge2);
+}
+
+
+
+/// Find intersections of edges of different polygons among sweep segments, in no particular order.
+//
+void sweepIntersections(vector<SweepSegment> &&segments, vector<EdgeIntersection> &rv)
+{
+	Sweep sweep(move(segments));
+
+	// Same pair can become adjacent several times
+	unordered_set<unsigned long long> testedPairs;
+
+	sweep.run([&](unsigned s1, unsigned s2) -> bool {
+		if ( sweep.segment(s1).owner == sweep.segment(s2).owner )
+			return true; // Edges of simple polygon do not cross
+
+		if ( sweep.segment(s1).owner != 0 )
+			swap(s1, s2);
+		SweepSegment const &seg1 = sweep.segment(s1);
+		SweepSegment const &seg2 = sweep.segment(s2);
+
+		if ( ! testedPairs.insert((unsigned long long)seg1.idx << 32 | seg2.idx).second )
+			return true;
+
+		EdgeIntersection isect;
+		isect.shape = intersect(seg1.edge, seg2.edge, isect.p1, isect.p2);
+		if ( isect.shape == Isect_Empty )
+			return true;
+
+		isect.edge1 = seg1.idx;
+		isect.edge2 = seg2.idx;
+		rv.push_back(isect);
+
+		if ( isect.shape == Isect_Point )
+			sweep.scheduleCrossing(s1, s2, isect.p1);
+
+		return true;
+	});
+}
+
+
+
+/// Number of consecutive edges of the first polygon swept together in parallel sweep.
+unsigned const SweepChunkEdges = 1024;
+
+
+
+Rect segmentBox(Point const &p1, Point const &p2)
+{
+	return Rect(Point(min(p1.x, p2.x), min(p1.y, p2.y)), Point(max(p1.x, p2.x), max(p1.y, p2.y)));
+}
+
+
+
+/// Edge of x-monotone chain.
+//
+struct ChainEdge
+{
+	Segment seg;
+	double xMin, xMax;
+	unsigned idx;   ///< Edge index in polygon.
+};
+
+typedef vector<ChainEdge> MonotoneChain;
+
+
+
+/// Split convex polygon into two chains monotone in x.
+/*!
+ * Edges of each chain are ordered by x, so both xMin and xMax do not decrease along chain.
+ */
+void splitToMonotoneChains(Polygon const &polygon, MonotoneChain chains[2])
+{
+	unsigned const n = polygon.numVertices();
+
+	auto const minmax = minmax_element(polygon.begin(), polygon.end());
+	unsigned const iMin = (unsigned)(minmax.first - polygon.begin());
+	unsigned const iMax = (unsigned)(minmax.second - polygon.begin());
+
+	// From the leftmost vertex to the rightmost one x increases, then decreases back
+	for ( unsigned i = iMin, chain = 0; chain < 2; i = (i + 1) % n ) {
+		if ( i == (chain == 0 ? iMax : iMin) ) {
+			++chain;
+			if ( chain == 2 )
+				break;
+		}
+
+		Segment const seg(polygon[i], polygon[(i + 1) % n]);
+		ChainEdge const edge = { seg, min(seg.p1.x, seg.p2.x), max(seg.p1.x, seg.p2.x), i };
+		chains[chain].push_back(edge);
+	}
+
+	reverse(chains[1].begin(), chains[1].end());
+}
+
+
+
+} // namespace
+
+
+
+vector<EdgeIntersection> findEdgeIntersections_BruteForce(Polygon const &p1, Polygon const &p2)
+{
+	vector<EdgeIntersection> rv;
+
+	SegmentBatch edges2;
+	edges2.reserve(p2.numVertices());
+	for ( auto seg2 = p2.edgeBegin(); seg2 != p2.edgeEnd(); ++seg2 )
+		edges2.add(*seg2);
+
+	// Pairs are prefiltered in batches, and only intersecting ones are computed
+	unsigned edge1 = 0;
+	for ( auto seg1 = p1.edgeBegin(); seg1 != p1.edgeEnd(); ++seg1, ++edge1 ) {
+		for ( unsigned edge2 = edges2.findIntersecting(*seg1); edge2 != edges2.size();
+		      edge2 = edges2.findIntersecting(*seg1, edge2 + 1) ) {
+			EdgeIntersection isect;
+			isect.shape = intersect(*seg1, edges2.segment(edge2), isect.p1, isect.p2);
+			if ( isect.shape == Isect_Empty )
+				continue;
+
+			isect.edge1 = edge1;
+			isect.edge2 = edge2;
+			rv.push_back(isect);
+		}
+	}
+
+	return rv;
+}
+
+
+
+vector<EdgeIntersection> findEdgeIntersections_Sweep(Polygon const &p1, Polygon const &p2)
+{
+	vector<SweepSegment> segments;
+	segments.reserve(p1.numVertices() + p2.numVertices());
+	addSweepSegments(p1, 0, segments);
+	addSweepSegments(p2, 1, segments);
+
+	vector<EdgeIntersection> rv;
+	sweepIntersections(move(segments), rv);
+
+	sort(rv.begin(), rv.end(), edgeIntersectionLess);
+	return rv;
+}
+
+
+
+vector<EdgeIntersection> findEdgeIntersections_ParallelSweep(Polygon const &p1, Polygon const &p2,
+                                                             unsigned threads)
+{
+	unsigned const n1 = p1.numVertices(), n2 = p2.numVertices();
+	unsigned const numChunks = (n1 + SweepChunkEdges - 1) / SweepChunkEdges;
+	if ( numChunks <= 1 )
+		return findEdgeIntersections_Sweep(p1, p2);
+
+	vector<Rect> boxes2(n2);
+	for ( unsigned j = 0; j < n2; ++j )
+		boxes2[j] = segmentBox(p2[j], p2[(j + 1) % n2]);
+
+	vector<vector<EdgeIntersection>> results(numChunks);
+	atomic<unsigned> nextChunk(0);
+
+	auto const worker = [&]{
+		for ( unsigned chunk; (chunk = nextChunk++) < numChunks; ) {
+			unsigned const begin = chunk * SweepChunkEdges;
+			unsigned const end = min(n1, begin + SweepChunkEdges);
+
+			vector<SweepSegment> segments;
+			Rect box(p1[begin], p1[begin]);
+			for ( unsigned i = begin; i < end; ++i ) {
+				Segment const seg(p1[i], p1[(i + 1) % n1]);
+				box.add(seg.p2);
+				if ( ! (seg.p1 == seg.p2) )
+					segments.emplace_back(seg, 0, i);
+			}
+
+			for ( unsigned j = 0; j < n2; ++j ) {
+				Segment const seg(p2[j], p2[(j + 1) % n2]);
+				if ( boxes2[j].intersects(box) && ! (seg.p1 == seg.p2) )
+					segments.emplace_back(seg, 1, j);
+			}
+
+			sweepIntersections(move(segments), results[chunk]);
+		}
+	};
+
+	if ( threads == 0 )
+		threads = thread::hardware_concurrency();
+	threads = max(1u, min(threads, numChunks));
+
+	vector<future<void>> helpers;
+	for ( unsigned t = 1; t < threads; ++t )
+		helpers.push_back(async(launch::async, worker));
+	worker();
+	for ( auto &helper : helpers )
+		helper.get();
+
+	vector<EdgeIntersection> rv;
+	for ( auto const &result : results )
+		rv.insert(rv.end(), result.begin(), result.end());
+
+	sort(rv.begin(), rv.end(), edgeIntersectionLess);
+	return rv;
+}
+
+
+
+vector<EdgeIntersection> findEdgeIntersections_Convex(Polygon const &p1, Polygon const &p2)
+{
+	MonotoneChain chains1[2], chains2[2];
+	splitToMonotoneChains(p1, chains1);
+	splitToMonotoneChains(p2, chains2);
+
+	vector<EdgeIntersection> rv;
+
+	for ( MonotoneChain const &chain1 : chains1 ) {
+		for ( MonotoneChain const &chain2 : chains2 ) {
+			// For each edge of chain1, test edges of chain2 overlapping it in x
+			size_t start = 0;
+			for ( ChainEdge const &edge1 : chain1 ) {
+				while ( start < chain2.size() && chain2[start].xMax < edge1.xMin )
+					++start;
+
+				for ( size_t j = start; j < chain2.size() && chain2[j].xMin <= edge1.xMax; ++j ) {
+					ChainEdge const &edge2 = chain2[j];
+					
+					EdgeIntersection isect;
+					isect.shape = intersect(edge1.seg, edge2.seg, isect.p1, isect.p2);
+					if ( isect.shape == Isect_Empty )
+						continue;
+
+					isect.edge1 = edge1.idx;
+					isect.edge2 = edge2.idx;
+					rv.push_back(isect);
+				}
+			}
+		}
+	}
+
+	sort(rv.begin(), rv.end(), edgeIntersectionLess);
+	return rv;
+}
+
+
+
+bool hasSelfIntersections_Sweep(Polygon const &polygon)
+{
+	unsigned const n = polygon.numVertices();
+
+	vector<SweepSegment> segments;
+	segments.reserve(n);
+
+	unsigned idx = 0;
+	for ( auto edge = polygon.edgeBegin(); edge != polygon.edgeEnd(); ++edge, ++idx ) {
+		Segment const seg = *edge;
+		if ( seg.p1 == seg.p2 )
+			return true;
+		segments.emplace_back(seg, 0, idx);
+	}
+
+	Sweep sweep(move(segments));
+
+	bool found = false;
+
+	// Nothing is crossed before the first intersection, so crossings are never scheduled
+	sweep.run([&](unsigned s1, unsigned s2) -> bool {
+		unsigned const d = s1 < s2 ? s2 - s1 : s1 - s2;
+		if ( d == 1 || d == n - 1 )
+			return true; // Adjacent edges
+
+		found = intersects(sweep.segment(s1).edge, sweep.segment(s2).edge);
+		return ! found;
+	});
+
+	return found;
+}
+
+
+
+} // namespace poly
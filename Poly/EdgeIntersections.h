@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Polygon.h"
+#include "Functions.h"
+
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Intersection of an edge of one polygon with an edge of another.
+//
+struct EdgeIntersection
+{
+	unsigned edge1, edge2;     ///< Edge indices in first and second polygon.
+	IntersectionShape shape;   ///< Never Isect_Empty.
+	Point p1, p2;              ///< Intersection points, as returned by intersect().
+};
+
+
+
+/// Find all intersecting pairs of edges of two polygons by testing each pair.
+/*!
+ * O(n*m). Pairs are prefiltered in batches by SegmentBatch.
+ *
+ * \return Intersections ordered by (edge1, edge2).
+ */
+std::vector<EdgeIntersection> findEdgeIntersections_BruteForce(Polygon const &p1,
+                                                               Polygon const &p2);
+
+/// Test if any two non-adjacent edges of polygon intersect, by Shamos-Hoey sweep.
+/*!
+ * O(n log n). Stops at the first found intersection.
+ *
+ * Adjacent edges are not tested against each other. Zero length edge is reported as
+ * intersection, since it makes its neighbour edges touch. Touching of vertex and edge interior
+ * can be missed due to rounding.
+ *
+ * \pre Polygon has more than 3 vertices.
+ */
+bool hasSelfIntersections_Sweep(Polygon const &polygon);
+
+/// Find all intersecting pairs of edges of two polygons by Bentley-Ottmann sweep.
+/*!
+ * O((n + m + k) log(n + m)), where k is the number of intersections.
+ *
+ * Each found pair is computed by the same intersect() call as in brute force version, so
+ * results of both functions are identical, except for degenerate cases listed below.
+ *
+ * Zero length edges are ignored. Touching of edges in vertices is detected, but touching of
+ * vertex and edge interior can be missed due to rounding.
+ *
+ * \pre Polygons are simple.
+ *
+ * \return Intersections ordered by (edge1, edge2).
+ */
+std::vector<EdgeIntersection> findEdgeIntersections_Sweep(Polygon const &p1,
+                                                          Polygon const &p2);
+
+/// Find all intersecting pairs of edges of two polygons by sweeps running in several threads.
+/*!
+ * Edges of p1 are split into chunks of consecutive edges, and each chunk is swept together with
+ * edges of p2 whose bounding boxes intersect bounding box of the chunk. Threads take chunks one
+ * by one from a shared counter, so a thread finishing early takes over remaining work.
+ *
+ * Chunks do not depend on the number of threads, and each pair of edges is tested in one chunk
+ * only, so results are identical for any number of threads. They are the same as of
+ * findEdgeIntersections_Sweep(), except for the degenerate cases listed for it.
+ *
+ * \pre Polygons are simple.
+ *
+ * \param threads  Number of threads, including the calling one. 0 means hardware concurrency.
+ *
+ * \return Intersections ordered by (edge1, edge2).
+ */
+std::vector<EdgeIntersection> findEdgeIntersections_ParallelSweep(Polygon const &p1,
+                                                                  Polygon const &p2,
+                                                                  unsigned threads);
+
+/// Find all intersecting pairs of edges of two convex polygons.
+/*!
+ * O(n + m + k log k). Each polygon is split into two chains monotone in x, and only edges of
+ * chains overlapping in x are tested, by the same intersect() call as in brute force version.
+ *
+ * \pre Polygons are convex.
+ *
+ * \return Intersections ordered by (edge1, edge2).
+ */
+std::vector<EdgeIntersection> findEdgeIntersections_Convex(Polygon const &p1,
+                                                           Polygon const &p2);
+
+
+
+} // namespace poly
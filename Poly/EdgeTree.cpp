@@ -0,0 +1,247 @@
+#include "EdgeTree.h"
+
+#include "Functions.h"
+
+#include <algorithm>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+/// Square of distance from point to box, 0 if inside.
+//
+static double boxDistanceSqr(Rect const &box, Point const &p)
+{
+	double const dx = p.x < box.pMin.x ? box.pMin.x - p.x : (p.x > box.pMax.x ? p.x - box.pMax.x : 0);
+	double const dy = p.y < box.pMin.y ? box.pMin.y - p.y : (p.y > box.pMax.y ? p.y - box.pMax.y : 0);
+	return dx*dx + dy*dy;
+}
+
+
+
+/// Square of distance from point to segment.
+/*! \return DBL_MAX in strict mode if the point does not project onto the segment.
+ */
+static double edgeDistanceSqr(Point const &p, Segment const &s, bool strict)
+{
+	Vector const d = s.toVector(), w(s.p1, p);
+
+	double const t = dotProduct(w, d);
+	double const len2 = dotProduct(d, d);
+
+	if ( t < 0 )
+		return strict ? DBL_MAX : distanceSqr(p, s.p1);
+	if ( t > len2 )
+		return strict ? DBL_MAX : distanceSqr(p, s.p2);
+	if ( len2 == 0 )
+		return distanceSqr(p, s.p1);
+
+	double const cross = perpDotProduct(d, w);
+	return cross * cross / len2;
+}
+
+
+
+static bool distanceLess(EdgeDistance const &d1, EdgeDistance const &d2)
+{
+	return d1.distanceSqr < d2.distanceSqr || (d1.distanceSqr == d2.distanceSqr && d1.edge < d2.edge);
+}
+
+
+
+EdgeDistance nearestEdge(Point const &p, Polygon const &polygon, double maxDistanceSqr, bool strict)
+{
+	EdgeDistance best = { NoEdge, DBL_MAX };
+
+	unsigned idx = 0;
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it, ++idx ) {
+		double const d = edgeDistanceSqr(p, *it, strict);
+		if ( d <= maxDistanceSqr && d < best.distanceSqr ) {
+			best.edge = idx;
+			best.distanceSqr = d;
+		}
+	}
+
+	return best;
+}
+
+
+
+EdgeTree::EdgeTree(Polygon const &polygon)
+{
+	unsigned idx = 0;
+	items.reserve(polygon.numVertices());
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it, ++idx ) {
+		Item const item = { *it, idx };
+		items.push_back(item);
+	}
+
+	if ( items.empty() )
+		return;
+
+	nodes.reserve(2 * items.size() / LeafSize + 1);
+	nodes.resize(1);
+	build(0, 0, (unsigned)items.size());
+}
+
+
+
+/// Build subtree of items [begin, end) in given node.
+//
+void EdgeTree::build(unsigned node, unsigned begin, unsigned end)
+{
+	Rect box(items[begin].edge.p1, items[begin].edge.p1);
+	for ( unsigned i = begin; i < end; ++i ) {
+		box.add(items[i].edge.p1);
+		box.add(items[i].edge.p2);
+	}
+	nodes[node].box = box;
+
+	if ( end - begin <= LeafSize ) {
+		nodes[node].first = begin;
+		nodes[node].count = end - begin;
+		return;
+	}
+
+	// Median split by centers along the longer side
+	bool const byX = box.width() >= box.height();
+	unsigned const mid = begin + (end - begin) / 2;
+	nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+		[byX](Item const &i1, Item const &i2) {
+			return byX ? i1.edge.p1.x + i1.edge.p2.x < i2.edge.p1.x + i2.edge.p2.x
+			           : i1.edge.p1.y + i1.edge.p2.y < i2.edge.p1.y + i2.edge.p2.y;
+		});
+
+	unsigned const first = (unsigned)nodes.size();
+	nodes[node].first = first;
+	nodes[node].count = 0;
+	nodes.resize(first + 2);
+
+	build(first, begin, mid);
+	build(first + 1, mid, end);
+}
+
+
+
+/// Visit edges not farther than bound, nearer subtrees first.
+/*!
+ * \param boundSqr  Square of distance bound; visitor may decrease it to prune the search.
+ * \param visit     Functor void(unsigned edge, double distanceSqr).
+ */
+template <typename Visitor>
+void EdgeTree::search(Point const &p, double const &boundSqr, bool strict, Visitor &visit) const
+{
+	if ( nodes.empty() )
+		return;
+
+	// Depth of median split tree is less than 32
+	pair<unsigned, double> stack[64];
+	unsigned top = 0;
+
+	stack[top++] = make_pair(0u, boxDistanceSqr(nodes[0].box, p));
+
+	while ( top > 0 ) {
+		--top;
+		if ( stack[top].second > boundSqr )
+			continue;
+
+		Node const &node = nodes[stack[top].first];
+
+		if ( node.count > 0 ) {
+			for ( unsigned i = node.first; i < node.first + node.count; ++i ) {
+				double const d = edgeDistanceSqr(p, items[i].edge, strict);
+				if ( d <= boundSqr && d < DBL_MAX )
+					visit(items[i].idx, d);
+			}
+			continue;
+		}
+
+		// Push farther child first, so that nearer one is visited first
+		pair<unsigned, double> c1(node.first, boxDistanceSqr(nodes[node.first].box, p));
+		pair<unsigned, double> c2(node.first + 1, boxDistanceSqr(nodes[node.first + 1].box, p));
+		if ( c1.second < c2.second )
+			swap(c1, c2);
+
+		if ( c1.second <= boundSqr )
+			stack[top++] = c1;
+		if ( c2.second <= boundSqr )
+			stack[top++] = c2;
+	}
+}
+
+
+
+EdgeDistance EdgeTree::nearest(Point const &p, double maxDistanceSqr, bool strict) const
+{
+	EdgeDistance best = { NoEdge, DBL_MAX };
+	double bound = maxDistanceSqr;
+
+	auto visit = [&](unsigned edge, double d) {
+		EdgeDistance const ed = { edge, d };
+		if ( distanceLess(ed, best) ) {
+			best = ed;
+			bound = d;
+		}
+	};
+	search(p, bound, strict, visit);
+
+	return best;
+}
+
+
+
+vector<EdgeDistance> EdgeTree::nearest(Point const &p, unsigned k, double maxDistanceSqr,
+                                       bool strict) const
+{
+	vector<EdgeDistance> heap;   // Max-heap of the best found
+	if ( k == 0 )
+		return heap;
+	heap.reserve(k);
+
+	double bound = maxDistanceSqr;
+
+	auto visit = [&](unsigned edge, double d) {
+		EdgeDistance const ed = { edge, d };
+		if ( heap.size() < k ) {
+			heap.push_back(ed);
+			push_heap(heap.begin(), heap.end(), distanceLess);
+		}
+		else if ( distanceLess(ed, heap.front()) ) {
+			pop_heap(heap.begin(), heap.end(), distanceLess);
+			heap.back() = ed;
+			push_heap(heap.begin(), heap.end(), distanceLess);
+		}
+		else
+			return;
+
+		if ( heap.size() == k )
+			bound = heap.front().distanceSqr;
+	};
+	search(p, bound, strict, visit);
+
+	sort_heap(heap.begin(), heap.end(), distanceLess);
+	return heap;
+}
+
+
+
+vector<EdgeDistance> EdgeTree::within(Point const &p, double distanceSqr, bool strict) const
+{
+	vector<EdgeDistance> rv;
+
+	auto visit = [&rv](unsigned edge, double d) {
+		EdgeDistance const ed = { edge, d };
+		rv.push_back(ed);
+	};
+	search(p, distanceSqr, strict, visit);
+
+	return rv;
+}
+
+
+
+} // namespace poly
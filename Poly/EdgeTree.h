@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Polygon.h"
+#include "Rect.h"
+
+#include <cfloat>
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Find the nearest edge of polygon within given distance, testing all edges.
+/*! O(n). See EdgeTree::nearest() for parameters.
+ */
+EdgeDistance nearestEdge(Point const &p, Polygon const &polygon, double maxDistanceSqr = DBL_MAX,
+                         bool strict = false);
+
+
+
+/// Bounding volume hierarchy of polygon edges, for distance queries.
+/*!
+ * Binary tree of bounding boxes, built once by median splits along the longer side of box.
+ * Queries visit nearer subtrees first and skip subtrees farther than the current bound, so
+ * they are O(log n) on average instead of O(n).
+ *
+ * Distance to an edge is the distance to the closest point of the segment. In strict mode,
+ * only edges onto which the point projects inside the segment are considered, as with
+ * distanceSqr_Strict().
+ *
+ * Edges are identified by index of the first vertex. The tree keeps copies of edges, and is not
+ * modified by queries.
+ */
+class EdgeTree
+{
+public:
+	explicit EdgeTree(Polygon const &polygon);
+
+	/// Find the nearest edge within given distance.
+	EdgeDistance nearest(Point const &p, double maxDistanceSqr = DBL_MAX, bool strict = false) const;
+
+	/// Find k nearest edges within given distance.
+	/*! \return Edges ordered by distance.
+	 */
+	std::vector<EdgeDistance> nearest(Point const &p, unsigned k, double maxDistanceSqr = DBL_MAX,
+	                                  bool strict = false) const;
+
+	/// Find all edges within given distance.
+	/*! \return Edges in no particular order.
+	 */
+	std::vector<EdgeDistance> within(Point const &p, double distanceSqr, bool strict = false) const;
+
+private:
+	enum { LeafSize = 4 };
+
+	struct Node {
+		Rect box;
+		unsigned first;   ///< First child for internal node, first item for leaf.
+		unsigned count;   ///< Number of items for leaf, 0 for internal node.
+	};
+
+	struct Item {
+		Segment edge;
+		unsigned idx;
+	};
+
+	void build(unsigned node, unsigned begin, unsigned end);
+
+	template <typename Visitor>
+	void search(Point const &p, double const &boundSqr, bool strict, Visitor &visit) const;
+
+//Fields
+	std::vector<Node> nodes;   ///< Children of each internal node are adjacent; root is 0.
+	std::vector<Item> items;
+};
+
+
+
+} // namespace poly
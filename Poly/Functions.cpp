@@ -4,9 +4,12 @@
 
 #include "Segment.h"
 #include "Polygon.h"
+#include "Rect.h"
+#include "SegmentBatch.h"
 
 #include "../Lib/Iterators.h"
 
+#include <algorithm>
 #include <cmath>
 #include <float.h>
 
@@ -32,25 +35,7 @@ double distanceSqr_Strict(Point const &p, Segment const &s)
 
 double distanceSqr(Point const &p, Polygon const &polygon)
 {
-	double dMin = DBL_MAX;
-
-	for ( Point const &vertex : polygon ) {
-		double const d = distanceSqr(p, vertex);
-		if ( d == 0 )
-			return 0;
-		if ( d < dMin )
-			dMin = d;
-	}
-
-	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it ) {
-		double const d = distanceSqr_Strict(p, *it);
-		if ( d == 0 )
-			return 0;
-		if ( d < dMin )
-			dMin = d;
-	}
-
-	return dMin;
+	return polygon.nearestEdge(p).distanceSqr;
 }
 
 
@@ -58,21 +43,21 @@ double distanceSqr(Point const &p, Polygon const &polygon)
 static bool areIntersecting_Segments_Crossing(Point const &p1, Point const &p2,
                                               Point const &p3, Point const &p4)
 {
-  int const i = (int) orientation(Vector(p1, p2), Vector(p1, p3));
+  int const i = (int) orientation(p1, p2, p3);
   if ( i == 0 )
     return true;
   else
-    return (int) orientation(Vector(p3, p4), Vector(p3, p2)) != -i;
+    return (int) orientation(p3, p4, p2) != -i;
 }
 
 static bool areIntersecting_Segments_Contained(Point const &p1, Point const &p2,
                                                Point const &p3, Point const &p4)
 {
-  int const i = (int) orientation(Vector(p1, p2), Vector(p1, p3));
+  int const i = (int) orientation(p1, p2, p3);
   if ( i == 0 )
     return true;
   else
-    return (int) orientation(Vector(p1, p2), Vector(p1, p4)) != i;
+    return (int) orientation(p1, p2, p4) != i;
 }
 
 
@@ -255,106 +240,187 @@ bool intersects(Segment const &s1, Segment const &s2)
 
 
 
-bool intersects(Polygon const &p1, Polygon const &p2)
+static Rect segmentBox(Point const &p1, Point const &p2)
 {
-	for ( auto seg1 = p1.edgeBegin(); seg1 != p1.edgeEnd(); ++seg1 ) {
-		for ( auto seg2 = p2.edgeBegin(); seg2 != p2.edgeEnd(); ++seg2 ) {
-			if ( intersects(*seg1, *seg2) )
-				return true;
-		}
-	}
-
-	return false;
+	return Rect(Point(std::min(p1.x, p2.x), std::min(p1.y, p2.y)),
+	            Point(std::max(p1.x, p2.x), std::max(p1.y, p2.y)));
 }
 
 
 
-double const SMALL_NUM = 0.00000001;
+/// Chain of consecutive polygon edges, monotone in both x and y.
+//
+struct MonotoneChain
+{
+	Rect box;
+	unsigned first, last;   ///< Indices of first and last edge, inclusive.
+};
 
 
 
-IntersectionShape intersect(Segment const s1, Segment const s2, Point &p1, Point &p2)
+/// Split edges of polygon having boxes intersecting with window into monotone chains.
+/*! Edges outside of the window are dropped, and chains are broken at them.
+ */
+static std::vector<MonotoneChain> monotoneChains(Polygon const &polygon, Rect const &window)
 {
-	// http://geomalgorithms.com/a05-_intersect-1.html
+	std::vector<MonotoneChain> chains;
+
+	unsigned const n = polygon.numVertices();
+	int prevDirection = -1;   // Quadrant of previous kept edge, -1 if previous edge was dropped
 	
-	Vector const u = s1.toVector();
-	Vector const v = s2.toVector();
-	Vector const w = s1.p1 - s2.p1;
-	double const d = perpDotProduct(u, v);
+	for ( unsigned i = 0; i < n; ++i ) {
+		Point const &v1 = polygon[i];
+		Point const &v2 = polygon[i + 1 < n ? i + 1 : 0];
+
+		Rect const box = segmentBox(v1, v2);
+		if ( ! box.intersects(window) ) {
+			prevDirection = -1;
+			continue;
+		}
 
-	// test if they are parallel (includes either being a point)
-	if ( fabs(d) < SMALL_NUM ) {           // parallel
-		if ( perpDotProduct(u, w) != 0 || perpDotProduct(v, w) != 0 )
-			return Isect_Empty;                    // they are NOT collinear
-		
-		// they are collinear or degenerate
-		
-		// check if they are degenerate  points
-		double const du = dotProduct(u, u);
-		double const dv = dotProduct(v, v);
-
-		//if ( du == 0 && dv == 0) {            // both segments are points
-		//	if (S1.P0 !=  S2.P0)         // they are distinct  points
-		//		return 0;
-		//	*I0 = S1.P0;                 // they are the same point
-		//	return 1;
-		//}
-		//if (du==0) {                     // S1 is a single point
-		//	if  (inSegment(S1.P0, S2) == 0)  // but is not in S2
-		//		return 0;
-		//	*I0 = S1.P0;
-		//	return 1;
-		//}
-		//if (dv==0) {                     // S2 a single point
-		//	if  (inSegment(S2.P0, S1) == 0)  // but is not in S1
-		//		return 0;
-		//	*I0 = S2.P0;
-		//	return 1;
-		//}
-
-		// they are collinear segments - get  overlap (or not)
-
-		double t0, t1;                    // endpoints of S1 in eqn for S2
-		Vector const w2 = s1.p2 - s2.p1;
-		if ( v.x != 0 ) {
-			t0 = w.x / v.x;
-			t1 = w2.x / v.x;
+		int const direction = (v2.x >= v1.x ? 1 : 0) | (v2.y >= v1.y ? 2 : 0);
+		if ( direction == prevDirection ) {
+			chains.back().box.add(v2);
+			chains.back().last = i;
 		}
 		else {
-			t0 = w.y / v.y;
-			t1 = w2.y / v.y;
-		}
-		if ( t0 > t1 ) {                   // must have t0 smaller than t1
-			double const t=t0; t0=t1; t1=t;    // swap if not
+			MonotoneChain const chain = { box, i, i };
+			chains.push_back(chain);
 		}
-		if ( t0 > 1 || t1 < 0 ) {
-			return Isect_Empty;      // NO overlap
+		prevDirection = direction;
+	}
+
+	return chains;
+}
+
+
+
+bool intersects(Polygon const &p1, Polygon const &p2, IntersectionTestLayer *decidedBy)
+{
+	IntersectionTestLayer dummy;
+	if ( ! decidedBy )
+		decidedBy = &dummy;
+
+	if ( p1.empty() || p2.empty() ) {
+		*decidedBy = IsectLayer_BoundingBox;
+		return false;
+	}
+
+	// Layer 1: whole polygons
+
+	Rect const &box1 = p1.boundingBox();
+	Rect const &box2 = p2.boundingBox();
+	if ( ! box1.intersects(box2) ) {
+		*decidedBy = IsectLayer_BoundingBox;
+		return false;
+	}
+
+	// Layer 2: edges. Only edges touching the common part of bounding boxes can intersect.
+
+	Rect const window(Point(std::max(box1.pMin.x, box2.pMin.x), std::max(box1.pMin.y, box2.pMin.y)),
+	                  Point(std::min(box1.pMax.x, box2.pMax.x), std::min(box1.pMax.y, box2.pMax.y)));
+
+	std::vector<MonotoneChain> const chains1 = monotoneChains(p1, window);
+	std::vector<MonotoneChain> chains2 = monotoneChains(p2, window);
+	if ( chains1.empty() || chains2.empty() ) {
+		*decidedBy = IsectLayer_EdgeBoxes;
+		return false;
+	}
+
+	// Layer 3: monotone chains. Pairs of chains are enumerated in order of left sides.
+
+	std::sort(chains2.begin(), chains2.end(), [](MonotoneChain const &c1, MonotoneChain const &c2)
+		{ return c1.box.pMin.x < c2.box.pMin.x; });
+
+	unsigned const n1 = p1.numVertices(), n2 = p2.numVertices();
+	bool chainsOverlap = false;
+
+	SegmentBatch edges2;   // Filled when the first pair of chains overlaps
+
+	for ( auto const &chain1 : chains1 ) {
+		for ( auto const &chain2 : chains2 ) {
+			if ( chain2.box.pMin.x > chain1.box.pMax.x )
+				break;
+			if ( ! chain1.box.intersects(chain2.box) )
+				continue;
+
+			if ( ! chainsOverlap ) {
+				edges2.reserve(n2);
+				for ( unsigned j = 0; j < n2; ++j )
+					edges2.add(Segment(p2[j], p2[j + 1 < n2 ? j + 1 : 0]));
+				chainsOverlap = true;
+			}
+
+			// Layer 4: exact test of edges, batched, prefiltered by edge boxes
+			for ( unsigned i = chain1.first; i <= chain1.last; ++i ) {
+				Segment const edge1(p1[i], p1[i + 1 < n1 ? i + 1 : 0]);
+				if ( ! segmentBox(edge1.p1, edge1.p2).intersects(chain2.box) )
+					continue;
+
+				if ( edges2.findIntersecting(edge1, chain2.first, chain2.last + 1) <= chain2.last ) {
+					*decidedBy = IsectLayer_Exact;
+					return true;
+				}
+			}
 		}
-		t0 = t0 < 0 ? 0 : t0;               // clip to min 0
-		t1 = t1 > 1 ? 1 : t1;               // clip to max 1
-		if ( t0 == t1 ) {                  // intersect is a point
-			p1 = s2.p1 +  t0 * v;
+	}
+
+	*decidedBy = chainsOverlap ? IsectLayer_Exact : IsectLayer_MonotoneChains;
+	return false;
+}
+
+
+
+IntersectionShape intersect(Segment const s1, Segment const s2, Point &p1, Point &p2)
+{
+	using predicates::orientSign;
+
+	// Sides of each segment relative to the other
+	int const o1 = orientSign(s1.p1, s1.p2, s2.p1);
+	int const o2 = orientSign(s1.p1, s1.p2, s2.p2);
+	if ( o1 == o2 && o1 != 0 )
+		return Isect_Empty;
+
+	int const o3 = orientSign(s2.p1, s2.p2, s1.p1);
+	int const o4 = orientSign(s2.p1, s2.p2, s1.p2);
+	if ( o3 == o4 && o3 != 0 )
+		return Isect_Empty;
+
+	if ( o1 == 0 && o2 == 0 ) {
+		// Collinear: overlap of lexicographically ordered segments
+		Point const &a1 = std::min(s1.p1, s1.p2), &a2 = std::max(s1.p1, s1.p2);
+		Point const &b1 = std::min(s2.p1, s2.p2), &b2 = std::max(s2.p1, s2.p2);
+		Point const &lo = std::max(a1, b1), &hi = std::min(a2, b2);
+		if ( hi < lo )
+			return Isect_Empty;
+		if ( lo == hi ) {
+			p1 = lo;
 			return Isect_Point;
 		}
 
-		// they overlap in a valid subsegment
-		p1 = s2.p1 + t0 * v;
-		p2 = s2.p1 + t1 * v;
+		// Points in direction of s2
+		bool const forward = s2.p1 < s2.p2;
+		p1 = forward ? lo : hi;
+		p2 = forward ? hi : lo;
 		return Isect_Segment;
 	}
 
-	// the segments are skew and may intersect in a point
-	// get the intersect parameter for S1
-	double const sI = perpDotProduct(v, w) / d;
-	if ( sI < 0 || sI > 1 )                // no intersect with S1
-		return Isect_Empty;
+	// Single point. If it is an endpoint, take it exactly.
+	if ( o1 == 0 ) { p1 = s2.p1;  return Isect_Point; }
+	if ( o2 == 0 ) { p1 = s2.p2;  return Isect_Point; }
+	if ( o3 == 0 ) { p1 = s1.p1;  return Isect_Point; }
+	if ( o4 == 0 ) { p1 = s1.p2;  return Isect_Point; }
 
-	// get the intersect parameter for S2
-	double const tI = perpDotProduct(u, w) / d;
-	if ( tI < 0 || tI > 1 )                // no intersect with S2
-		return Isect_Empty;
+	// Proper crossing
+	// http://geomalgorithms.com/a05-_intersect-1.html
+	Vector const u = s1.toVector();
+	Vector const v = s2.toVector();
+	Vector const w = s1.p1 - s2.p1;
+	double const d = perpDotProduct(u, v);
+	double sI = d != 0 ? perpDotProduct(v, w) / d : 0.5;
+	sI = sI < 0 ? 0 : (sI > 1 ? 1 : sI);
 
-	p1 = s1.p1 + sI * u;                // compute S1 intersect point
+	p1 = s1.p1 + sI * u;
 	return Isect_Point;
 }
 
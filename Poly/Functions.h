@@ -4,6 +4,7 @@
 #include "Vector.h"
 #include "Segment.h"
 #include "Line.h"
+#include "Predicates.h"
 
 
 
@@ -44,19 +45,26 @@ inline double perpDotProduct(Vector const &v1, Vector const &v2)
 enum Orientation { Left = 1, Right = -1, Collinear = 0 };
 
 /// Get orientation of v2 relative to v1.
-//
+/*! Not exact: components of vectors are usually already rounded. Use point overloads when
+ *  points are known.
+ */
 inline Orientation orientation(Vector const &v1, Vector const &v2) {
 	double const p = perpDotProduct(v1, v2);
 	return p < 0 ? Left : (p > 0 ? Right : Collinear);
 }
 
-inline Orientation orientation(Point const &p0, Point const &p1, Point const &p2)
-{ return orientation(Vector(p0, p1), Vector(p0, p2)); }
+/// Get orientation of p2 relative to vector from p0 to p1.
+/*! Exact, see predicates.
+ */
+inline Orientation orientation(Point const &p0, Point const &p1, Point const &p2) {
+	int const s = predicates::orientSign(p0, p1, p2);
+	return s < 0 ? Left : (s > 0 ? Right : Collinear);
+}
 
 /// Get orientation of point relative to vector.
 //
 inline Orientation orientation(Point const &p, Segment const &s)
-{ return orientation(s.toVector(), Vector(s.p1, p)); }
+{ return orientation(s.p1, s.p2, p); }
 
 
 
@@ -91,13 +99,33 @@ double distanceSqr(Point const &p, Polygon const &polygon);
 
 bool intersects(Segment const &s1, Segment const &s2);
 
-bool intersects(Polygon const &p1, Polygon const &p2);
+/// Layers of polygon intersection test, from cheapest to most expensive.
+//
+enum IntersectionTestLayer {
+	IsectLayer_BoundingBox,      ///< Bounding boxes of polygons.
+	IsectLayer_EdgeBoxes,        ///< Bounding boxes of edges against common part of polygon boxes.
+	IsectLayer_MonotoneChains,   ///< Bounding boxes of monotone chains of edges.
+	IsectLayer_Exact             ///< Exact test of edges.
+};
+
+/// Test if polygon contours intersect or touch.
+/*!
+ * Cheap layers reject far apart polygons and parts of polygons, and only edges that can
+ * intersect are tested exactly. Each layer is tried only if previous ones did not decide.
+ *
+ * \param[out] decidedBy  Layer decided the answer, if not null. Positive answer is always
+ *                        given by IsectLayer_Exact.
+ */
+bool intersects(Polygon const &p1, Polygon const &p2, IntersectionTestLayer *decidedBy = nullptr);
 
 
 enum IntersectionShape { Isect_Empty, Isect_Point, Isect_Segment };
 
 /// Find intersection of two segments.
 /*!
+ * Kind of intersection is determined exactly. Intersection points that are endpoints of
+ * segments are returned exactly, proper crossing point is rounded.
+ *
  * \pre Segments are not degenerate.
  *
  * \param[in]  s1  Segment 1.
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "Functions.h"
+#include "Polygon.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Arithmetic of predicates on coordinates of type T.
+/*!
+ * Integral coordinates are computed in exact integer arithmetic, floating-point ones with
+ * filtered predicates in double (see predicates namespace).
+ *
+ * ExactInDouble tells if coordinates convert to double without rounding. Then Polygon made
+ * by toPolygon() keeps input vertices exactly, and boolean operations decide topology of
+ * such input exactly; only new intersection vertices are rounded.
+ */
+template <typename T, bool Integral = std::is_integral<T>::value>
+struct CoordTraits;
+
+
+/// Integral coordinates.
+/*! \pre Absolute values of coordinates are less than 2^62, so that differences fit in 64 bits.
+ */
+template <typename T>
+struct CoordTraits<T, true>
+{
+	static_assert(sizeof(T) <= sizeof(int64_t), "Integral coordinates wider than 64 bits");
+
+	static bool const ExactInDouble = std::numeric_limits<T>::digits <= std::numeric_limits<double>::digits;
+
+	/// Exact sign of cross product (b - a) x (d - c).
+	static int crossSign(BasicPoint<T> const &a, BasicPoint<T> const &b,
+	                     BasicPoint<T> const &c, BasicPoint<T> const &d)
+	{
+		return predicates::productDiffSign(int64_t(b.x) - int64_t(a.x), int64_t(d.y) - int64_t(c.y),
+		                                   int64_t(b.y) - int64_t(a.y), int64_t(d.x) - int64_t(c.x));
+	}
+};
+
+
+/// Floating-point coordinates.
+//
+template <typename T>
+struct CoordTraits<T, false>
+{
+	static_assert(std::numeric_limits<T>::digits <= std::numeric_limits<double>::digits,
+	              "Floating-point coordinates wider than double");
+
+	static bool const ExactInDouble = true;
+
+	/// Exact sign of cross product (b - a) x (d - c).
+	static int crossSign(BasicPoint<T> const &a, BasicPoint<T> const &b,
+	                     BasicPoint<T> const &c, BasicPoint<T> const &d)
+	{
+		return predicates::crossSign(Point(a), Point(b), Point(c), Point(d));
+	}
+};
+
+
+
+/// Get orientation of p2 relative to vector from p0 to p1.
+/*! Exact, see CoordTraits.
+ */
+template <typename T>
+Orientation orientation(BasicPoint<T> const &p0, BasicPoint<T> const &p1, BasicPoint<T> const &p2)
+{
+	int const s = CoordTraits<T>::crossSign(p0, p1, p0, p2);
+	return s < 0 ? Left : (s > 0 ? Right : Collinear);
+}
+
+
+
+/// Test if point lies in bounding box of segment.
+//
+template <typename T>
+bool inBoundingBox(BasicPoint<T> const &p, BasicSegment<T> const &s)
+{
+	return std::min(s.p1.x, s.p2.x) <= p.x && p.x <= std::max(s.p1.x, s.p2.x) &&
+	       std::min(s.p1.y, s.p2.y) <= p.y && p.y <= std::max(s.p1.y, s.p2.y);
+}
+
+
+
+/// Test if segments intersect or touch.
+/*! Exact, see CoordTraits.
+ */
+template <typename T>
+bool intersects(BasicSegment<T> const &s1, BasicSegment<T> const &s2)
+{
+	Orientation const o1 = orientation(s1.p1, s1.p2, s2.p1);
+	Orientation const o2 = orientation(s1.p1, s1.p2, s2.p2);
+	Orientation const o3 = orientation(s2.p1, s2.p2, s1.p1);
+	Orientation const o4 = orientation(s2.p1, s2.p2, s1.p2);
+
+	if ( o1 != o2 && o3 != o4 && o1 != Collinear && o2 != Collinear &&
+	     o3 != Collinear && o4 != Collinear )
+		return true;
+
+	// Touch: endpoint of one segment lies on the other
+	return (o1 == Collinear && inBoundingBox(s2.p1, s1)) ||
+	       (o2 == Collinear && inBoundingBox(s2.p2, s1)) ||
+	       (o3 == Collinear && inBoundingBox(s1.p1, s2)) ||
+	       (o4 == Collinear && inBoundingBox(s1.p2, s2));
+}
+
+
+
+/// Locate point relative to closed contour.
+/*!
+ * Exact, see CoordTraits. Inside is decided by nonzero winding number, as inside() of Polygon.
+ * O(n).
+ */
+template <typename T>
+PointLocation locatePoint(BasicPoint<T> const &p, std::vector<BasicPoint<T>> const &contour)
+{
+	int wn = 0;
+	for ( size_t i = 0; i < contour.size(); ++i ) {
+		BasicPoint<T> const &v = contour[i];
+		BasicPoint<T> const &v1 = contour[i + 1 < contour.size() ? i + 1 : 0];
+
+		Orientation const o = orientation(v, v1, p);
+		if ( o == Collinear && inBoundingBox(p, BasicSegment<T>(v, v1)) )
+			return PointLoc_Boundary;
+
+		if ( v.y <= p.y ) {
+			if ( v1.y > p.y && o == Left )
+				++wn;
+		}
+		else {
+			if ( v1.y <= p.y && o == Right )
+				--wn;
+		}
+	}
+
+	return wn != 0 ? PointLoc_Inside : PointLoc_Outside;
+}
+
+
+
+/// Test if point is inside closed contour, not on its boundary.
+//
+template <typename T>
+bool inside(BasicPoint<T> const &p, std::vector<BasicPoint<T>> const &contour)
+{ return locatePoint(p, contour) == PointLoc_Inside; }
+
+
+
+/// Make polygon of contour, converting coordinates to double.
+/*! Exact if CoordTraits<T>::ExactInDouble.
+ *
+ * \throw invalid_argument If contour is empty.
+ */
+template <typename T>
+Polygon toPolygon(std::vector<BasicPoint<T>> const &contour)
+{
+	std::vector<Point> vertices;
+	vertices.reserve(contour.size());
+	for ( auto const &p : contour )
+		vertices.push_back(Point(p));
+	return Polygon(std::move(vertices));
+}
+
+
+
+} // namespace poly
@@ -1,9 +1,9 @@
 #pragma once
 
+#include "Point.h"
 
-namespace poly {
 
-class Point;
+namespace poly {
 
 
 
@@ -0,0 +1,190 @@
+#include "MultiRingPolygon.h"
+
+#include "Functions.h"
+#include "RTree.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+MultiRingPolygon::MultiRingPolygon(Polygon const &outer)
+	: ringStarts(1, 0)
+{
+	if ( outer.empty() )
+		throw invalid_argument("No vertices");
+
+	addRing(outer, true);
+}
+
+
+
+void MultiRingPolygon::addHole(Polygon const &hole)
+{
+	if ( hole.empty() )
+		throw invalid_argument("No vertices");
+	if ( empty() )
+		throw invalid_argument("No outer ring");
+
+	addRing(hole, false);
+}
+
+
+
+void MultiRingPolygon::addRing(Polygon const &ring, bool ccw)
+{
+	if ( ring.isCcw() == ccw )
+		vertices.insert(vertices.end(), ring.begin(), ring.end());
+	else
+		vertices.insert(vertices.end(), reverse_iterator<Polygon::const_iterator>(ring.end()),
+		                                reverse_iterator<Polygon::const_iterator>(ring.begin()));
+
+	ringStarts.push_back(unsigned(vertices.size()));
+}
+
+
+
+Polygon MultiRingPolygon::ring(unsigned ring) const
+{
+	return Polygon(vector<Point>(ringBegin(ring), ringEnd(ring)));
+}
+
+
+
+Rect MultiRingPolygon::boundingBox() const
+{
+	if ( empty() )
+		throw domain_error("Empty polygon");
+
+	Rect bbox(vertices.front(), vertices.front());
+	for ( Point const *p = ringBegin(0); p != ringEnd(0); ++p )
+		bbox.add(*p);
+	return bbox;
+}
+
+
+
+double MultiRingPolygon::area() const
+{
+	// Holes are clockwise, so signed areas of all rings sum up to the area of region.
+	// Orientation is defined for Y axis pointing down, as in Polygon.
+	double area2 = 0;
+	for ( unsigned r = 0; r < numRings(); ++r ) {
+		Point const *prev = ringEnd(r) - 1;
+		for ( Point const *p = ringBegin(r); p != ringEnd(r); prev = p++ )
+			area2 += prev->x * p->y - p->x * prev->y;
+	}
+	return -area2 / 2;
+}
+
+
+
+PointLocation MultiRingPolygon::locate(Point const &p) const
+{
+	// Winding number over all rings: holes wind in opposite direction
+	int wn = 0;
+	for ( unsigned r = 0; r < numRings(); ++r ) {
+		Point const *v = ringEnd(r) - 1;
+		for ( Point const *v1 = ringBegin(r); v1 != ringEnd(r); v = v1++ ) {
+			Orientation const o = orientation(*v, *v1, p);
+			if ( o == Collinear && min(v->x, v1->x) <= p.x && p.x <= max(v->x, v1->x) &&
+			                       min(v->y, v1->y) <= p.y && p.y <= max(v->y, v1->y) )
+				return PointLoc_Boundary;
+
+			if ( v->y <= p.y ) {
+				if ( v1->y > p.y && o == Left )
+					++wn;
+			}
+			else {
+				if ( v1->y <= p.y && o == Right )
+					--wn;
+			}
+		}
+	}
+
+	return wn != 0 ? PointLoc_Inside : PointLoc_Outside;
+}
+
+
+
+void MultiRingPolygon::translate(Vector const &v)
+{
+	for ( Point &p : vertices )
+		p += v;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Point of hole lying strictly inside or outside of outer ring.
+/*!
+ * Hole can touch outer ring at vertices, but not along edges, so some vertex or middle of edge
+ * does not lie on the outer ring.
+ */
+static PointLocation locateHole(Polygon const &hole, Polygon const &outer)
+{
+	for ( auto it = hole.edgeBegin(); it != hole.edgeEnd(); ++it ) {
+		Segment const edge = *it;
+		PointLocation loc = outer.locate(edge.p1);
+		if ( loc == PointLoc_Boundary )
+			loc = outer.locate(edge.p1 + 0.5 * edge.toVector());
+		if ( loc != PointLoc_Boundary )
+			return loc;
+	}
+	return PointLoc_Boundary;
+}
+
+
+
+vector<MultiRingPolygon> assembleRings(vector<Polygon> &&contours)
+{
+	vector<Polygon const *> outers, holes;
+	for ( Polygon const &c : contours )
+		(c.isCcw() ? outers : holes).push_back(&c);
+
+	vector<MultiRingPolygon> rv;
+	rv.reserve(outers.size());
+
+	RTree<unsigned> index;
+	for ( unsigned i = 0; i < outers.size(); ++i ) {
+		rv.push_back(MultiRingPolygon(*outers[i]));
+		index.insert(outers[i]->boundingBox(), i);
+	}
+
+	for ( Polygon const *hole : holes ) {
+		// Nested outer rings contain each other, so the smallest one containing the hole is
+		// the one it belongs to
+		Rect const &box = hole->boundingBox();
+		unsigned best = ~0u;
+		double bestArea = 0;
+		index.query(box, [&](Rect const &outerBox, unsigned i) {
+			if ( ! outerBox.contains(box) )
+				return;
+			double const area = outers[i]->signedArea();
+			if ( (best == ~0u || area < bestArea) && locateHole(*hole, *outers[i]) == PointLoc_Inside ) {
+				best = i;
+				bestArea = area;
+			}
+		});
+
+		if ( best == ~0u )
+			throw logic_error("Hole outside of outer rings");
+		rv[best].addHole(*hole);
+	}
+
+	contours.clear();
+	return rv;
+}
+
+
+
+} // namespace poly
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Polygon.h"
+
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Polygon with holes: outer ring and any number of hole rings.
+/*!
+ * Vertices of all rings are stored in one contiguous buffer, outer ring first, with offsets of
+ * rings. Ring 0 is the outer one, rings 1..numHoles() are holes.
+ *
+ * Outer ring is counterclockwise and holes are clockwise; rings are reoriented when added.
+ * Rings are not checked: they should be simple, holes should lie inside the outer ring and
+ * not overlap each other. Touching at vertices is allowed.
+ *
+ * The class has move constructor and move assignment operator with \c noexcept specification.
+ */
+class MultiRingPolygon
+{
+public:
+	MultiRingPolygon() : ringStarts(1, 0) {}
+
+	/// \throw invalid_argument If outer ring is empty.
+	explicit MultiRingPolygon(Polygon const &outer);
+
+	MultiRingPolygon(MultiRingPolygon &&r) _NOEXCEPT : ringStarts(1, 0) { swap(r); }
+	MultiRingPolygon& operator=(MultiRingPolygon &&r) _NOEXCEPT { swap(r); return *this; }
+
+	/// \throw invalid_argument If hole is empty, or there is no outer ring.
+	void addHole(Polygon const &hole);
+
+	bool empty() const { return vertices.empty(); }
+
+	unsigned numRings() const { return unsigned(ringStarts.size() - 1); }
+	unsigned numHoles() const { return empty() ? 0 : numRings() - 1; }
+	unsigned numVertices() const { return unsigned(vertices.size()); }
+
+	/// Vertices of ring.
+	Point const * ringBegin(unsigned ring) const { return vertices.data() + ringStarts[ring]; }
+	Point const * ringEnd(unsigned ring)   const { return vertices.data() + ringStarts[ring + 1]; }
+	unsigned ringSize(unsigned ring) const { return ringStarts[ring + 1] - ringStarts[ring]; }
+
+	/// Copy of ring as separate polygon.
+	Polygon ring(unsigned ring) const;
+
+	/// Bounding box of outer ring.
+	/*! \throw domain_error If polygon is empty.
+	 */
+	Rect boundingBox() const;
+
+	/// Area of outer ring minus areas of holes.
+	double area() const;
+
+	/// Locate point relative to the region. Boundaries of holes are boundary of the region.
+	/*! O(n).
+	 */
+	PointLocation locate(Point const &p) const;
+
+	void translate(Vector const &v);
+
+	void swap(MultiRingPolygon &r) _NOEXCEPT { vertices.swap(r.vertices); ringStarts.swap(r.ringStarts); }
+
+private:
+	void addRing(Polygon const &ring, bool ccw);
+
+//Fields
+	std::vector<Point> vertices;
+	std::vector<unsigned> ringStarts;   ///< Offsets of rings in vertices, and the total size.
+};
+
+
+
+/// Assemble contours of region into polygons with holes.
+/*!
+ * Counterclockwise contours are outer rings, clockwise ones are holes, as boolean operations
+ * return them. Contours must not cross each other.
+ *
+ * Each hole is assigned to the smallest outer ring containing it. Candidates are found by
+ * R-tree of bounding boxes of outer rings, and containment is tested by Polygon::locate(), so
+ * assembly is O((n + h) log n) for n outer rings and h holes, instead of testing all pairs.
+ *
+ * \throw logic_error If a hole is not inside any outer ring.
+ */
+std::vector<MultiRingPolygon> assembleRings(std::vector<Polygon> &&contours);
+
+
+
+} // namespace poly
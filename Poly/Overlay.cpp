@@ -0,0 +1,215 @@
+#include "Overlay.h"
+
+#include "RTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+/// Polygons of the first layer with at least this number of candidate pairs are prepared.
+static size_t const OverlayPrepareMin = 8;
+
+/// Number of polygons of the first layer evaluated by a thread at once.
+static size_t const OverlayChunk = 16;
+
+
+
+/// Completes chunks left unevaluated after overlay has been stopped.
+//
+struct OverlayAborted : runtime_error {
+	OverlayAborted() : runtime_error("Overlay aborted") {}
+};
+
+
+
+/// Compute and cache properties read by boolean operations, so that afterwards polygon is
+/// only read and can be shared by threads.
+//
+static void computeProperties(Polygon const &p)
+{
+	if ( p.empty() )
+		return;
+	p.boundingBox();
+	p.isSimple();
+	p.isCcw();
+	p.isConvex();
+}
+
+
+
+static bool hasResults(BooleanResults const &r)
+{
+	return ! (r.sum.empty() && r.intersection.empty() && r.difference12.empty() &&
+	          r.difference21.empty() && r.symDifference.empty());
+}
+
+
+
+/// Evaluate pairs of polygon of the first layer with its candidates.
+/*!
+ * \param[out] results  Receives results of pairs with nonempty ones, and failed pairs with
+ *                      their exceptions.
+ */
+template <typename Operand1>
+static void evaluatePairs(Operand1 const &pa, unsigned a, vector<unsigned> const &candidates,
+                          vector<Polygon const *> const &layerB, unsigned operations,
+                          vector<OverlayResult> &results)
+{
+	for ( unsigned b : candidates ) {
+		OverlayResult r;
+		r.a = a;
+		r.b = b;
+		try {
+			r.results = evaluateBoolean(pa, *layerB[b], operations);
+		}
+		catch ( exception const & ) {
+			r.results = BooleanResults();
+			r.error = current_exception();
+		}
+		if ( r.error || hasResults(r.results) )
+			results.push_back(move(r));
+	}
+}
+
+
+
+void overlay(vector<Polygon const *> const &layerA, vector<Polygon const *> const &layerB,
+             unsigned operations, function<void (OverlayResult &&)> const &visit, unsigned threads)
+{
+	if ( threads == 0 )
+		threads = thread::hardware_concurrency();
+	threads = max(1u, threads);
+
+	// Sequentially, as the same polygon can occur in layers several times
+	for ( Polygon const *p : layerA )
+		computeProperties(*p);
+	for ( Polygon const *p : layerB )
+		computeProperties(*p);
+
+	// Candidate pairs
+	vector<pair<Rect, unsigned>> boxes;
+	boxes.reserve(layerB.size());
+	for ( unsigned b = 0; b < layerB.size(); ++b )
+		if ( ! layerB[b]->empty() )
+			boxes.emplace_back(layerB[b]->boundingBox(), b);
+	RTree<unsigned> const index = RTree<unsigned>::bulkLoad(boxes);
+
+	vector<vector<unsigned>> candidates(layerA.size());
+	for ( size_t a = 0; a < layerA.size(); ++a ) {
+		if ( layerA[a]->empty() )
+			continue;
+		index.query(layerA[a]->boundingBox(), [&](Rect const &, unsigned b) {
+			candidates[a].push_back(b);
+		});
+		sort(candidates[a].begin(), candidates[a].end());
+	}
+
+	// Evaluate pairs by chunks of the first layer. Chunks are taken in order, and the calling
+	// thread passes results of each chunk to visitor when it is ready.
+	size_t const numChunks = (layerA.size() + OverlayChunk - 1) / OverlayChunk;
+	vector<promise<vector<OverlayResult>>> chunkPromises(numChunks);
+	vector<future<vector<OverlayResult>>> chunkResults;
+	for ( auto &p : chunkPromises )
+		chunkResults.push_back(p.get_future());
+
+	atomic<size_t> nextChunk(0);
+	atomic<bool> stop(false);
+	exception_ptr error;    // first failure of a chunk, set before stop
+	mutex errorMutex;
+
+	// Take next chunk and evaluate it. After a failure of visitor or evaluation (other than of a
+	// pair) chunks are completed with OverlayAborted instead of partial results.
+	auto const evaluateNext = [&]() -> bool {
+		size_t const chunk = nextChunk++;
+		if ( chunk >= numChunks )
+			return false;
+
+		vector<OverlayResult> rv;
+		try {
+			size_t const end = min(layerA.size(), (chunk + 1) * OverlayChunk);
+			for ( size_t a = chunk * OverlayChunk; a < end; ++a ) {
+				if ( stop )
+					throw OverlayAborted();
+				if ( candidates[a].size() >= OverlayPrepareMin && layerA[a]->isSimple() )
+					evaluatePairs(PreparedPolygon(*layerA[a]), unsigned(a), candidates[a], layerB,
+					              operations, rv);
+				else
+					evaluatePairs(*layerA[a], unsigned(a), candidates[a], layerB, operations, rv);
+			}
+			chunkPromises[chunk].set_value(move(rv));
+		}
+		catch ( OverlayAborted const & ) {
+			chunkPromises[chunk].set_exception(current_exception());
+		}
+		catch ( ... ) {
+			{
+				lock_guard<mutex> lock(errorMutex);
+				if ( ! error )
+					error = current_exception();
+			}
+			stop = true;
+			chunkPromises[chunk].set_exception(current_exception());
+		}
+		return true;
+	};
+
+	vector<future<void>> helpers;
+	for ( unsigned t = 1; t < min<size_t>(threads, numChunks); ++t )
+		helpers.push_back(async(launch::async, [&]{ while ( evaluateNext() ) {} }));
+	auto const stopHelpers = [&]() {
+		stop = true;
+		for ( auto &helper : helpers )
+			helper.wait();
+	};
+
+	try {
+		size_t delivered = 0;
+		auto const deliver = [&](bool wait) {
+			while ( delivered < numChunks &&
+			        (wait || chunkResults[delivered].wait_for(chrono::seconds(0)) == future_status::ready) ) {
+				for ( auto &r : chunkResults[delivered++].get() )
+					visit(move(r));
+			}
+		};
+
+		while ( evaluateNext() )
+			deliver(false);
+		deliver(true);
+	}
+	catch ( OverlayAborted const & ) {
+		// Chunk preceding the failed one was aborted by it
+		stopHelpers();
+		rethrow_exception(error);
+	}
+	catch ( ... ) {
+		stopHelpers();
+		throw;
+	}
+}
+
+
+
+vector<OverlayResult> overlay(vector<Polygon const *> const &layerA,
+                              vector<Polygon const *> const &layerB,
+                              unsigned operations, unsigned threads)
+{
+	vector<OverlayResult> rv;
+	overlay(layerA, layerB, operations, [&](OverlayResult &&r) { rv.push_back(move(r)); }, threads);
+	return rv;
+}
+
+
+
+} // namespace poly
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Boolean.h"
+
+#include <exception>
+#include <functional>
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Results of boolean operations on a pair of polygons from two layers.
+//
+struct OverlayResult {
+	unsigned a;               ///< Index of polygon in the first layer.
+	unsigned b;               ///< Index of polygon in the second layer.
+	BooleanResults results;
+	std::exception_ptr error; ///< Exception thrown by evaluation of the pair, results are empty.
+};
+
+/// Overlay two layers of polygons.
+/*!
+ * Computes boolean operations for each pair of polygons (a, b) from layers A and B whose
+ * bounding boxes intersect, as evaluateBoolean(). Candidate pairs are found through R-tree of
+ * layer B bulk-loaded by RTree::bulkLoad(), so only O(N log M + K) pairs are examined instead
+ * of all N*M. Suited for intersection of layers: pairs with disjoint bounding boxes are not
+ * evaluated at all, so p1 - p2 for them is not reported.
+ *
+ * Polygons of A with many candidates are prepared once for all of them, see PreparedPolygon.
+ * Pairs are evaluated by given number of threads, by polygons of A.
+ *
+ * Results are passed to visit in the calling thread, as soon as they are ready, ordered by a
+ * and then by b, for any number of threads. Pairs with all requested results empty are
+ * skipped.
+ *
+ * A pair that evaluateBoolean() fails for (touching edges, result with holes) does not stop
+ * the overlay: it is passed to visit with the exception in OverlayResult::error.
+ *
+ * Polygons must not be modified or used from other threads during the call.
+ *
+ * \param operations  Combination of BooleanOp flags.
+ * \param visit       Receives results of each pair.
+ * \param threads     Number of threads, including the calling one. 0 means hardware
+ *                    concurrency.
+ *
+ * \throw Exceptions of visit. Evaluation stops at the first one.
+ */
+void overlay(std::vector<Polygon const *> const &layerA, std::vector<Polygon const *> const &layerB,
+             unsigned operations, std::function<void (OverlayResult &&)> const &visit,
+             unsigned threads = 0);
+
+/// Overlay two layers of polygons, collecting all results.
+/*! \see overlay(std::vector<Polygon const *> const &, std::vector<Polygon const *> const &,
+ *       unsigned, std::function<void (OverlayResult &&)> const &, unsigned)
+ */
+std::vector<OverlayResult> overlay(std::vector<Polygon const *> const &layerA,
+                                   std::vector<Polygon const *> const &layerB,
+                                   unsigned operations, unsigned threads = 0);
+
+
+
+} // namespace poly
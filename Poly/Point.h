@@ -5,22 +5,36 @@ namespace poly {
 
 
 
-class Point
+/// Point with coordinates of type T.
+/*!
+ * The library works with double coordinates (Point). Other coordinate types are for compact or
+ * integral storage of data; predicates on them are selected by CoordTraits, see Kernel.h.
+ */
+template <typename T>
+class BasicPoint
 {
 public:
-	Point() {}
-	Point(double x, double y) : x(x), y(y) {}
+	typedef T Coord;
 
-	bool operator==(Point const &r) const { return x == r.x && y == r.y; }
+	BasicPoint() {}
+	BasicPoint(T x, T y) : x(x), y(y) {}
+
+	/// Convert coordinates from another type.
+	template <typename U>
+	explicit BasicPoint(BasicPoint<U> const &p) : x(static_cast<T>(p.x)), y(static_cast<T>(p.y)) {}
+
+	bool operator==(BasicPoint const &r) const { return x == r.x && y == r.y; }
 	
 	// Lexicographical order
 	//
-	bool operator<(Point const &r) const { return x < r.x || (x == r.x && y < r.y); }
+	bool operator<(BasicPoint const &r) const { return x < r.x || (x == r.x && y < r.y); }
 
 // Fields
-	double x, y;
+	T x, y;
 };
 
+typedef BasicPoint<double> Point;
+
 
 
 } // namespace poly
@@ -0,0 +1,178 @@
+#include "PointClassifier.h"
+
+#include "Functions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <thread>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+/// Number of points classified by a thread at once.
+static size_t const ClassifyChunk = 4096;
+
+/// Limit of the average number of bands spanned by an edge, which bounds the number of edge
+/// copies by (MaxBandsPerEdge + 2) * n.
+static double const MaxBandsPerEdge = 4;
+
+
+
+PointClassifier::PointClassifier(Polygon const &polygon)
+	: bandScale(0)
+	, numBands(1)
+{
+	unsigned const n = polygon.numVertices();
+	if ( n == 0 ) {
+		bandBegin.assign(2, 0);
+		return;
+	}
+
+	bbox = polygon.boundingBox();
+	if ( bbox.height() > 0 ) {
+		// One band per edge, unless edges are long: an edge of height dy spans dy * bandScale
+		// bands, plus at most two partially
+		double spanSum = 0;
+		for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it ) {
+			Segment const edge = *it;
+			spanSum += fabs(edge.p2.y - edge.p1.y);
+		}
+		spanSum /= bbox.height();
+
+		numBands = n;
+		if ( spanSum > MaxBandsPerEdge )
+			numBands = max(1u, (unsigned)(MaxBandsPerEdge * n / spanSum));
+		bandScale = numBands / bbox.height();
+	}
+
+	// Counting sort of edges by bands: count, then place
+	vector<unsigned> counts(numBands + 1, 0);
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it ) {
+		Segment const edge = *it;
+		unsigned const first = bandOf(min(edge.p1.y, edge.p2.y));
+		unsigned const last = bandOf(max(edge.p1.y, edge.p2.y));
+		for ( unsigned band = first; band <= last; ++band )
+			++counts[band + 1];
+	}
+
+	bandBegin.resize(numBands + 1);
+	bandBegin[0] = 0;
+	for ( unsigned band = 0; band < numBands; ++band )
+		bandBegin[band + 1] = bandBegin[band] + counts[band + 1];
+
+	edges.resize(bandBegin[numBands], Segment(Point(0, 0), Point(0, 0)));
+	vector<unsigned> pos(bandBegin.begin(), bandBegin.end() - 1);
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it ) {
+		Segment const edge = *it;
+		unsigned const first = bandOf(min(edge.p1.y, edge.p2.y));
+		unsigned const last = bandOf(max(edge.p1.y, edge.p2.y));
+		for ( unsigned band = first; band <= last; ++band )
+			edges[pos[band]++] = edge;
+	}
+}
+
+
+
+/// Band containing given y.
+/*!
+ * Monotone in y, so band of any y within range of edge lies within bands listing the edge.
+ */
+unsigned PointClassifier::bandOf(double y) const
+{
+	double const band = (y - bbox.pMin.y) * bandScale;
+	if ( ! (band > 0) )
+		return 0;
+	return band >= numBands ? numBands - 1 : (unsigned)band;
+}
+
+
+
+PointLocation PointClassifier::classify(Point const &p) const
+{
+	if ( edges.empty() || ! bbox.contains(p) )
+		return PointLoc_Outside;
+
+	unsigned const band = bandOf(p.y);
+
+	// Winding number, as in inside()
+	int wn = 0;
+
+	for ( unsigned i = bandBegin[band]; i != bandBegin[band + 1]; ++i ) {
+		Point const &v = edges[i].p1, &v1 = edges[i].p2;
+
+		if ( max(v.y, v1.y) < p.y || p.y < min(v.y, v1.y) )
+			continue;
+
+		if ( p.x <= max(v.x, v1.x) && min(v.x, v1.x) <= p.x ) {
+			// Point within box of edge: it can lie on the edge
+			int const s = predicates::orientSign(v, v1, p);
+			if ( s == 0 )
+				return PointLoc_Boundary;
+
+			if ( v.y <= p.y ) {
+				if ( v1.y > p.y && s < 0 )
+					++wn;
+			}
+			else if ( v1.y <= p.y && s > 0 )
+				--wn;
+		}
+		else if ( max(v.x, v1.x) < p.x ) {
+			// Edge is to the left of point, orientation is known
+			if ( v.y <= p.y ) {
+				if ( v1.y > p.y )
+					++wn;
+			}
+			else if ( v1.y <= p.y )
+				--wn;
+		}
+	}
+
+	return wn != 0 ? PointLoc_Inside : PointLoc_Outside;
+}
+
+
+
+void PointClassifier::classify(Point const *points, size_t count, unsigned char *out,
+                               unsigned threads) const
+{
+	size_t const numChunks = (count + ClassifyChunk - 1) / ClassifyChunk;
+	atomic<size_t> nextChunk(0);
+
+	auto const worker = [&]{
+		for ( size_t chunk; (chunk = nextChunk++) < numChunks; ) {
+			size_t const end = min(count, (chunk + 1) * ClassifyChunk);
+			for ( size_t i = chunk * ClassifyChunk; i < end; ++i )
+				out[i] = (unsigned char)classify(points[i]);
+		}
+	};
+
+	if ( threads == 0 )
+		threads = thread::hardware_concurrency();
+	threads = (unsigned)max<size_t>(1, min<size_t>(threads, numChunks));
+
+	vector<future<void>> helpers;
+	for ( unsigned t = 1; t < threads; ++t )
+		helpers.push_back(async(launch::async, worker));
+	worker();
+	for ( auto &helper : helpers )
+		helper.get();
+}
+
+
+
+void classifyPoints(Polygon const &polygon, Point const *points, size_t count, unsigned char *out,
+                    unsigned threads)
+{
+	PointClassifier(polygon).classify(points, count, out, threads);
+}
+
+
+
+} // namespace poly
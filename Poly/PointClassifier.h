@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Polygon.h"
+#include "Rect.h"
+
+#include <cstddef>
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Polygon prepared for classification of many points.
+/*!
+ * Bounding box of polygon is cut into horizontal bands of equal height, about one band per
+ * edge, and each band lists the edges overlapping it in y. A point is classified by winding
+ * number over the edges of its band only, so for polygons without long runs of edges spanning
+ * many bands it is O(1) on average instead of O(n).
+ *
+ * Long edges would be copied into many bands, up to O(n^2) copies in total. So the number of
+ * bands is reduced to keep edges spanning at most a few bands on average: memory is O(n), and
+ * polygons of long edges get longer bands, up to O(n) per query.
+ *
+ * Orientations are tested exactly, so boundary points are found exactly, and the result for
+ * other points is the same as of inside().
+ *
+ * The object keeps copies of edges, and is not modified after construction, so it can be used
+ * from several threads.
+ *
+ * \pre Polygon can be self-intersecting.
+ */
+class PointClassifier
+{
+public:
+	explicit PointClassifier(Polygon const &polygon);
+
+	PointLocation classify(Point const &p) const;
+
+	/// Classify array of points.
+	/*!
+	 * Points are split into chunks processed by given number of threads.
+	 *
+	 * \param[out] out      PointLocation for each point.
+	 * \param      threads  Number of threads, including the calling one. 0 means hardware
+	 *                      concurrency.
+	 */
+	void classify(Point const *points, size_t count, unsigned char *out, unsigned threads = 1) const;
+
+	/// Total number of edges listed in bands, for tests and benchmarks.
+	size_t numStoredEdges() const { return edges.size(); }
+
+private:
+	unsigned bandOf(double y) const;
+
+	Rect bbox;
+	double bandScale;   ///< Number of bands per unit of y.
+	unsigned numBands;
+
+	std::vector<unsigned> bandBegin;   ///< Range of band i in edges is [bandBegin[i], bandBegin[i+1]).
+	std::vector<Segment> edges;
+};
+
+
+
+/// Classify array of points relative to polygon.
+/*!
+ * Prepares PointClassifier once for all points.
+ *
+ * \param[out] out      PointLocation for each point.
+ * \param      threads  Number of threads, see PointClassifier::classify().
+ */
+void classifyPoints(Polygon const &polygon, Point const *points, size_t count, unsigned char *out,
+                    unsigned threads = 1);
+
+
+
+} // namespace poly
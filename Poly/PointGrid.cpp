@@ -0,0 +1,292 @@
+#include "PointGrid.h"
+
+#include "Functions.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+static bool boxContains(Point const &a, Point const &b, Point const &p)
+{
+	return min(a.x, b.x) <= p.x && p.x <= max(a.x, b.x) && min(a.y, b.y) <= p.y && p.y <= max(a.y, b.y);
+}
+
+
+
+/// Contribution of edge to winding number of point, as counted by inside().
+//
+static int windingCrossing(Point const &v, Point const &v1, Point const &p)
+{
+	if ( v.y <= p.y ) {
+		if ( v1.y > p.y && orientation(v, v1, p) == Left )
+			return 1;
+	}
+	else {
+		if ( v1.y <= p.y && orientation(v, v1, p) == Right )
+			return -1;
+	}
+	return 0;
+}
+
+
+
+template <typename EdgeIterator>
+static PointLocation locateByEdges(Point const &p, EdgeIterator begin, EdgeIterator end)
+{
+	int wn = 0;
+	for ( ; begin != end; ++begin ) {
+		Segment const edge = *begin;
+		if ( boxContains(edge.p1, edge.p2, p) && predicates::orientSign(edge.p1, edge.p2, p) == 0 )
+			return PointLoc_Boundary;
+		wn += windingCrossing(edge.p1, edge.p2, p);
+	}
+	return wn != 0 ? PointLoc_Inside : PointLoc_Outside;
+}
+
+
+
+PointLocation locatePoint(Point const &p, Polygon const &polygon)
+{
+	return locateByEdges(p, polygon.edgeBegin(), polygon.edgeEnd());
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Margin in cell sizes by which an edge is extended when finding cells it passes through.
+static double const CellPad = 1e-6;
+
+
+
+/// Visit cells that edge passes through, row by row.
+/*!
+ * In each row of its Y range the edge spans columns between its X at the bottom and the top of
+ * the row. Ranges are widened by CellPad in grid units, so that cells of points computed with
+ * rounding by column() and row() are not missed.
+ */
+template <typename Visitor>
+void PointGrid::visitCells(Segment const &edge, Visitor visit) const
+{
+	// Grid coordinates of ends, the lower one first
+	Point a((edge.p1.x - bbox.pMin.x) * xScale, (edge.p1.y - bbox.pMin.y) * yScale);
+	Point b((edge.p2.x - bbox.pMin.x) * xScale, (edge.p2.y - bbox.pMin.y) * yScale);
+	if ( b.y < a.y )
+		swap(a, b);
+	double const dxdy = b.y > a.y ? (b.x - a.x) / (b.y - a.y) : 0;
+
+	auto const gridColumn = [this](double x) -> unsigned {
+		return ! (x > 0) ? 0 : x >= cols ? cols - 1 : (unsigned)x;
+	};
+
+	unsigned const r0 = row(min(edge.p1.y, edge.p2.y)), r1 = row(max(edge.p1.y, edge.p2.y));
+	for ( unsigned r = r0; r <= r1; ++r ) {
+		double x0 = a.x, x1 = b.x;
+		if ( b.y > a.y ) {
+			x0 = a.x + (max(a.y, r - CellPad) - a.y) * dxdy;
+			x1 = a.x + (min(b.y, r + 1 + CellPad) - a.y) * dxdy;
+		}
+		unsigned const c1 = gridColumn(max(x0, x1) + CellPad);
+		for ( unsigned c = gridColumn(min(x0, x1) - CellPad); c <= c1; ++c )
+			visit(r * cols + c);
+	}
+}
+
+
+
+PointGrid::PointGrid(Polygon const &polygon)
+	: bbox(polygon.boundingBox())
+{
+	edges.reserve(polygon.numVertices());
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it )
+		edges.push_back(*it);
+
+	// About one cell per edge, cells close to squares
+	unsigned const n = (unsigned)edges.size();
+	double const w = bbox.width(), h = bbox.height();
+	if ( w > 0 && h > 0 ) {
+		cols = (unsigned)max(1.0, min((double)n, floor(sqrt(n * w / h) + 0.5)));
+		rows = max(1u, min(n, n / cols));
+	}
+	else {
+		cols = w > 0 ? n : 1;
+		rows = h > 0 ? n : 1;
+	}
+
+	cellWidth = w / cols;
+	cellHeight = h / rows;
+	xScale = w > 0 ? 1 / cellWidth : 0;
+	yScale = h > 0 ? 1 / cellHeight : 0;
+
+	// Cell lists by counting sort: count, then place
+	unsigned const numCells = cols * rows;
+	vector<unsigned> counts(numCells, 0);
+	for ( Segment const &edge : edges )
+		visitCells(edge, [&](unsigned cell) { ++counts[cell]; });
+
+	cellBegin.resize(numCells + 1);
+	cellBegin[0] = 0;
+	for ( unsigned cell = 0; cell < numCells; ++cell )
+		cellBegin[cell + 1] = cellBegin[cell] + counts[cell];
+
+	cellEdges.resize(cellBegin[numCells]);
+	vector<unsigned> pos(cellBegin.begin(), cellBegin.end() - 1);
+	for ( unsigned i = 0; i < n; ++i )
+		visitCells(edges[i], [&](unsigned cell) { cellEdges[pos[cell]++] = i; });
+
+	computeCenterWindings();
+}
+
+
+
+unsigned PointGrid::column(double x) const
+{
+	double const c = (x - bbox.pMin.x) * xScale;
+	if ( ! (c > 0) )
+		return 0;
+	return c >= cols ? cols - 1 : (unsigned)c;
+}
+
+
+
+unsigned PointGrid::row(double y) const
+{
+	double const r = (y - bbox.pMin.y) * yScale;
+	if ( ! (r > 0) )
+		return 0;
+	return r >= rows ? rows - 1 : (unsigned)r;
+}
+
+
+
+Point PointGrid::cellCenter(unsigned col, unsigned row) const
+{
+	return Point(bbox.pMin.x + (col + 0.5) * cellWidth, bbox.pMin.y + (row + 0.5) * cellHeight);
+}
+
+
+
+/// Compute winding numbers of cell centers row by row.
+/*!
+ * Edge crossing the horizontal line through centers of a row contributes to centers to the
+ * right of the crossing. The first such center is found by binary search with exact
+ * orientation, then contributions are accumulated along the row.
+ */
+void PointGrid::computeCenterWindings()
+{
+	centerWinding.assign(cols * rows, 0);
+	centerOnBoundary.assign(cols * rows, false);
+
+	vector<int> delta(cols + 1);
+	vector<unsigned> lastRow(edges.size(), ~0u);   // Edges are listed in several cells of a row
+
+	for ( unsigned r = 0; r < rows; ++r ) {
+		fill(delta.begin(), delta.end(), 0);
+		double const cy = cellCenter(0, r).y;
+
+		for ( unsigned c = 0; c < cols; ++c ) {
+			unsigned const cell = r * cols + c;
+			for ( unsigned k = cellBegin[cell]; k != cellBegin[cell + 1]; ++k ) {
+				unsigned const idx = cellEdges[k];
+				if ( lastRow[idx] == r )
+					continue;
+				lastRow[idx] = r;
+
+				Point const &v = edges[idx].p1, &v1 = edges[idx].p2;
+
+				// Centers lying on the edge
+				if ( min(v.y, v1.y) <= cy && cy <= max(v.y, v1.y) ) {
+					unsigned const c1 = column(max(v.x, v1.x));
+					for ( unsigned cc = column(min(v.x, v1.x)); cc <= c1; ++cc ) {
+						Point const center = cellCenter(cc, r);
+						if ( boxContains(v, v1, center) && predicates::orientSign(v, v1, center) == 0 )
+							centerOnBoundary[r * cols + cc] = true;
+					}
+				}
+
+				int const contribution = v.y <= cy ? (v1.y > cy ? 1 : 0) : (v1.y <= cy ? -1 : 0);
+				if ( contribution == 0 )
+					continue;
+
+				// First center counting the edge
+				unsigned lo = 0, hi = cols;
+				while ( lo < hi ) {
+					unsigned const mid = (lo + hi) / 2;
+					if ( windingCrossing(v, v1, cellCenter(mid, r)) != 0 )
+						hi = mid;
+					else
+						lo = mid + 1;
+				}
+				delta[lo] += contribution;
+			}
+		}
+
+		int wn = 0;
+		for ( unsigned c = 0; c < cols; ++c ) {
+			wn += delta[c];
+			centerWinding[r * cols + c] = wn;
+		}
+	}
+}
+
+
+
+PointLocation PointGrid::locate(Point const &p) const
+{
+	if ( ! bbox.contains(p) )
+		return PointLoc_Outside;
+
+	unsigned const c = column(p.x), r = row(p.y);
+	unsigned const cell = r * cols + c;
+	Point const center = cellCenter(c, r);
+
+	// Segment from center to point must stay in the cell, which is not so only in extreme
+	// precision loss
+	if ( centerOnBoundary[cell] || column(center.x) != c || row(center.y) != r )
+		return locateByEdges(p, edges.begin(), edges.end());
+
+	int wn = centerWinding[cell];
+
+	for ( unsigned k = cellBegin[cell]; k != cellBegin[cell + 1]; ++k ) {
+		Segment const &edge = edges[cellEdges[k]];
+		Point const &a = edge.p1, &b = edge.p2;
+
+		int const sideP = predicates::orientSign(a, b, p);
+		if ( sideP == 0 && boxContains(a, b, p) )
+			return PointLoc_Boundary;
+
+		if ( p == center )
+			continue;
+
+		// Vertex on the way from center to point
+		int const sideA = predicates::orientSign(p, center, a);
+		int const sideB = predicates::orientSign(p, center, b);
+		if ( (sideA == 0 && boxContains(p, center, a)) || (sideB == 0 && boxContains(p, center, b)) )
+			return locateByEdges(p, edges.begin(), edges.end());
+
+		if ( sideA == 0 || sideB == 0 || sideA == sideB || sideP == 0 )
+			continue;
+
+		int const sideCenter = predicates::orientSign(a, b, center);
+		if ( sideCenter == 0 || sideCenter == sideP )
+			continue;
+
+		// Crossing the edge to its left side decreases the count of inside()
+		wn += sideP > 0 ? -1 : 1;
+	}
+
+	return wn != 0 ? PointLoc_Inside : PointLoc_Outside;
+}
+
+
+
+} // namespace poly
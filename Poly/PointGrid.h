@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Polygon.h"
+#include "Rect.h"
+#include "Segment.h"
+
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Locate point relative to polygon by testing all edges.
+/*!
+ * O(n). Orientations are tested exactly. For points not on boundary the result is the same
+ * as of inside().
+ *
+ * \pre Polygon can be self-intersecting.
+ */
+PointLocation locatePoint(Point const &p, Polygon const &polygon);
+
+
+
+/// Uniform grid over polygon for fast point location.
+/*!
+ * Bounding box of polygon is divided into about as many cells as there are edges. Each cell
+ * lists edges passing through it, and keeps winding number at its center. An edge is listed in
+ * cells along it rather than in all cells of its bounding box, so long diagonal edges take
+ * O(length) cells, not O(length^2).
+ *
+ * A point in a cell without edges takes location of the center. Otherwise the winding number
+ * of the center is corrected by edges of the cell crossed by the segment from the center to
+ * the point. So query is O(1) for evenly distributed edges. Degenerate cases (center on an
+ * edge, vertex on the segment) fall back to locatePoint().
+ *
+ * Normally used through Polygon::locate(), which builds the grid on demand.
+ *
+ * \pre Polygon is not empty.
+ */
+class PointGrid
+{
+public:
+	explicit PointGrid(Polygon const &polygon);
+
+	PointLocation locate(Point const &p) const;
+
+private:
+	unsigned column(double x) const;
+	unsigned row(double y) const;
+	Point cellCenter(unsigned col, unsigned row) const;
+
+	template <typename Visitor>
+	void visitCells(Segment const &edge, Visitor visit) const;
+
+	void computeCenterWindings();
+
+//Fields
+	Rect bbox;
+	unsigned cols, rows;
+	double cellWidth, cellHeight;
+	double xScale, yScale;   ///< Inverse cell sizes, 0 for zero size of box.
+
+	std::vector<Segment> edges;
+	std::vector<unsigned> cellBegin;   ///< Edges of cell i are cellEdges[cellBegin[i] .. cellBegin[i+1]).
+	std::vector<unsigned> cellEdges;
+
+	std::vector<int> centerWinding;    ///< Winding number at cell center, as counted by inside().
+	std::vector<char> centerOnBoundary;
+};
+
+
+
+} // namespace poly
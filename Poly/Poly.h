@@ -8,5 +8,16 @@
 #include "Point.h"
 #include "Vector.h"
 #include "Segment.h"
+#include "Rect.h"
 #include "Functions.h"
 #include "Boolean.h"
+#include "PreparedPolygon.h"
+#include "RectClip.h"
+#include "PointClassifier.h"
+#include "PointGrid.h"
+#include "EdgeTree.h"
+#include "Kernel.h"
+#include "SnapBoolean.h"
+#include "MultiRingPolygon.h"
+#include "Overlay.h"
+#include "PolylineClip.h"
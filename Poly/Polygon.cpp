@@ -1,8 +1,14 @@
 #include "Polygon.h"
+#include "Functions.h"
+#include "EdgeIntersections.h"
+#include "SegmentBatch.h"
+#include "PointGrid.h"
+#include "EdgeTree.h"
 
 #include "../Lib/Iterators.h"
 
 #include <algorithm>
+#include <cmath>
 
 
 using namespace poly;
@@ -11,40 +17,207 @@ using namespace std;
 
 
 Polygon::Polygon(list<Point> const &vertices)
+	: cached(0)
+	, locateQueries(0)
+	, edgeQueries(0)
 {
 	if ( vertices.empty() )
 		throw invalid_argument("No vertices");
 
-	this->vertices = vertices;
+	this->vertices.assign(vertices.begin(), vertices.end());
 }
 
 
 
+Polygon::Polygon(vector<Point> &&vertices)
+	: cached(0)
+	, locateQueries(0)
+	, edgeQueries(0)
+{
+	if ( vertices.empty() )
+		throw invalid_argument("No vertices");
+
+	this->vertices.swap(vertices);
+}
+
+
+
+void Polygon::swap(Polygon &r) _NOEXCEPT
+{
+	vertices.swap(r.vertices);
+	std::swap(props, r.props);
+	std::swap(cached, r.cached);
+	pointGrid.swap(r.pointGrid);
+	std::swap(locateQueries, r.locateQueries);
+	edgeTree.swap(r.edgeTree);
+	std::swap(edgeQueries, r.edgeQueries);
+}
+
+
+
+void Polygon::setVertex(const_iterator at, Point const &vertex)
+{
+	*remove_constness(vertices, at) = vertex;
+	invalidate();
+}
+
+
+
+void Polygon::translate(Vector const &v)
+{
+	for ( Point &p : vertices )
+		p += v;
+
+	// Other properties do not depend on position
+	if ( cached & Cached_Metrics )
+		props.bbox.translate(v);
+
+	pointGrid.reset();
+	edgeTree.reset();
+}
+
+
+
+/// Polygons with at least this number of vertices are tested for simplicity by sweep.
+/// Testing all pairs of edges is faster for smaller ones.
+static unsigned const isSimpleSweepThreshold = 128;
+
+
+
 bool Polygon::isSimple() const
+{
+	if ( ! (cached & Cached_Simple) ) {
+		props.simple = testSimple();
+		cached |= Cached_Simple;
+	}
+	return props.simple;
+}
+
+
+
+bool Polygon::testSimple() const
 {
 	if ( numVertices() < 3 )
 		return false;
 	
 	if ( numVertices() == 3 )
 		return true;
+
+	if ( isConvex() )
+		return true;
 	
-	unsigned n_3 = numVertices() - 3;
-	
-	ConstEdgeIterator itCur = edgeBegin();
-
-	ConstEdgeIterator itTestStart = itCur; ++ ++itTestStart;
-	for ( unsigned i = 0; i <= n_3; ++i, ++itCur, ++itTestStart ) {
-		ConstEdgeIterator it = itTestStart;
-		for ( unsigned i1 = 0; i1 <= n_3 - max((unsigned)1, i); ++i1, ++it )
-			if ( intersects(*itCur, *it) )
-				return false;
+	if ( numVertices() >= isSimpleSweepThreshold )
+		return ! hasSelfIntersections_Sweep(*this);
+
+	unsigned const n = numVertices();
+
+	SegmentBatch edges;
+	edges.reserve(n);
+	for ( auto it = edgeBegin(); it != edgeEnd(); ++it )
+		edges.add(*it);
+
+	// Each edge against following non-adjacent ones
+	for ( unsigned i = 0; i + 3 <= n; ++i ) {
+		unsigned const end = i == 0 ? n - 1 : n;
+		if ( edges.findIntersecting(edges.segment(i), i + 2, end) != end )
+			return false;
 	}
 	return true;
 }
 
 
 
+bool Polygon::isConvex() const
+{
+	if ( ! (cached & Cached_Convex) ) {
+		props.convex = testConvex();
+		cached |= Cached_Convex;
+	}
+	return props.convex;
+}
+
+
+
+namespace {
+
+/// Count changes of sign in cyclic sequence of numbers, zeros are skipped.
+//
+class SignChangeCounter
+{
+public:
+	SignChangeCounter() : first(0), last(0), changes(0) {}
+
+	void add(double d) {
+		if ( d == 0 )
+			return;
+		int const sign = d > 0 ? 1 : -1;
+		if ( first == 0 )
+			first = sign;
+		else if ( sign != last )
+			++changes;
+		last = sign;
+	}
+
+	/// Number of changes, including one between last and first numbers.
+	unsigned total() const { return changes + (last != first ? 1 : 0); }
+
+private:
+	int first, last;
+	unsigned changes;
+};
+
+} // namespace
+
+
+
+/*!
+ * All turns in the same direction are not enough, because polygon can wind several times,
+ * like a pentagram. Convex polygon also changes direction of movement along each axis only
+ * twice.
+ */
+bool Polygon::testConvex() const
+{
+	unsigned const n = numVertices();
+	if ( n < 3 )
+		return false;
+
+	int turn = 0;
+	SignChangeCounter xChanges, yChanges;
+
+	for ( unsigned i = 0; i < n; ++i ) {
+		Point const &v1 = vertices[i];
+		Point const &v2 = vertices[(i + 1) % n];
+		Point const &v3 = vertices[(i + 2) % n];
+
+		Vector const e1(v1, v2);
+		int const cross = predicates::crossSign(v1, v2, v2, v3);
+		if ( cross == 0 )
+			return false;
+		if ( turn == 0 )
+			turn = cross;
+		else if ( cross != turn )
+			return false;
+
+		xChanges.add(e1.x);
+		yChanges.add(e1.y);
+	}
+
+	return xChanges.total() == 2 && yChanges.total() == 2;
+}
+
+
+
 bool Polygon::isCcw() const
+{
+	if ( ! (cached & Cached_Ccw) ) {
+		props.ccw = testCcw();
+		cached |= Cached_Ccw;
+	}
+	return props.ccw;
+}
+
+
+bool Polygon::testCcw() const
 {
 	auto const v = min_element(vertices.begin(), vertices.end());
 	return orientation(*prev_cyclic(v, vertices), *v, *next_cyclic(v, vertices)) == Left;
@@ -53,8 +226,17 @@ bool Polygon::isCcw() const
 
 void Polygon::makeCcw()
 {
-	if ( ! isCcw() )
-		vertices.reverse();
+	if ( isCcw() )
+		return;
+
+	reverse(vertices.begin(), vertices.end());
+
+	props.ccw = true;
+	props.signedArea = -props.signedArea;
+
+	// Edge tree refers to edges by index
+	edgeTree.reset();
+	edgeQueries = 0;
 }
 
 
@@ -64,3 +246,89 @@ Polygon Polygon::toCcw() const
 	ccw.makeCcw();
 	return ccw;
 }
+
+
+
+void Polygon::computeMetrics() const
+{
+	if ( vertices.empty() )
+		throw domain_error("Empty polygon");
+
+	Rect bbox(vertices.front(), vertices.front());
+	double area2 = 0;
+	double perimeter = 0;
+
+	Point const *prev = &vertices.back();
+	for ( Point const &p : vertices ) {
+		bbox.add(p);
+		area2 += prev->x * p.y - p.x * prev->y;
+		perimeter += sqrt(distanceSqr(*prev, p));
+		prev = &p;
+	}
+
+	props.bbox = bbox;
+	// Orientation is defined for Y axis pointing down, as on screen
+	props.signedArea = -area2 / 2;
+	props.perimeter = perimeter;
+	cached |= Cached_Metrics;
+}
+
+
+
+Rect const & Polygon::boundingBox() const
+{
+	if ( ! (cached & Cached_Metrics) )
+		computeMetrics();
+	return props.bbox;
+}
+
+
+double Polygon::signedArea() const
+{
+	if ( ! (cached & Cached_Metrics) )
+		computeMetrics();
+	return props.signedArea;
+}
+
+
+double Polygon::perimeter() const
+{
+	if ( ! (cached & Cached_Metrics) )
+		computeMetrics();
+	return props.perimeter;
+}
+
+
+
+/// Polygons with at least this number of vertices build point grid.
+static unsigned const PointGridMinVertices = 64;
+
+/// Number of locate() calls after which point grid is built.
+static unsigned const PointGridQueries = 8;
+
+
+PointLocation Polygon::locate(Point const &p) const
+{
+	if ( ! pointGrid && numVertices() >= PointGridMinVertices && ++locateQueries > PointGridQueries )
+		pointGrid = make_shared<PointGrid const>(*this);
+
+	return pointGrid ? pointGrid->locate(p) : locatePoint(p, *this);
+}
+
+
+
+/// Polygons with at least this number of vertices build edge tree.
+static unsigned const EdgeTreeMinVertices = 64;
+
+/// Number of nearestEdge() calls after which edge tree is built.
+static unsigned const EdgeTreeQueries = 8;
+
+
+EdgeDistance Polygon::nearestEdge(Point const &p, double maxDistanceSqr, bool strict) const
+{
+	if ( ! edgeTree && numVertices() >= EdgeTreeMinVertices && ++edgeQueries > EdgeTreeQueries )
+		edgeTree = make_shared<EdgeTree const>(*this);
+
+	return edgeTree ? edgeTree->nearest(p, maxDistanceSqr, strict)
+	                : poly::nearestEdge(p, *this, maxDistanceSqr, strict);
+}
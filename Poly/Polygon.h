@@ -2,14 +2,43 @@
 
 #include "Point.h"
 #include "Segment.h"
-#include "Functions.h" //TODO: only for "p += v"
+#include "Rect.h"
 
+#include <cfloat>
 #include <list>
+#include <memory>
+#include <vector>
 
 
 
 namespace poly {
 
+class PointGrid;
+class EdgeTree;
+
+
+
+/// Location of point relative to polygon.
+//
+enum PointLocation {
+	PointLoc_Outside  = 0,
+	PointLoc_Inside   = 1,
+	PointLoc_Boundary = 2   ///< On an edge or in a vertex.
+};
+
+
+
+/// Index of no edge.
+unsigned const NoEdge = ~0u;
+
+/// Edge found by distance query.
+//
+struct EdgeDistance
+{
+	unsigned edge;        ///< Index of edge (of its first vertex), NoEdge if not found.
+	double distanceSqr;   ///< Square of distance from query point.
+};
+
 
 
 /// Polygon
@@ -17,6 +46,9 @@ namespace poly {
  * Polygon is essentially a list of vertices, so begin()/end() return vertex iterators.
  * Iteration by edges is possible with edgeBegin()/edgeEnd().
  *
+ * Vertices are stored contiguously. insertVertex() and removeVertex() invalidate iterators
+ * at and after the position, addVertex() can invalidate all iterators.
+ *
  * Polygon can have any number of vertices. It can be self-intersecting. Order can be clockwise
  * or counterclockwise. If this is not desirable, higher level logic should impose restrictions.
  *
@@ -24,12 +56,17 @@ namespace poly {
  * constructs.
  *
  * The class has move constructor ang move assignment operator with \c noexcept specification.
+ *
+ * Vertices can be modified only through member functions. Derived properties (bounding box,
+ * simplicity, convexity, orientation, area, perimeter, point grid, edge tree) are computed on first
+ * request and cached until vertices change. Translation keeps cached properties, moving the
+ * bounding box. Since the cache is filled by const member functions, concurrent first requests
+ * to the same polygon from different threads are not safe.
  */
 class Polygon
 {
 public:
-	typedef std::list<Point> VertexList;
-	typedef VertexList::iterator       iterator;
+	typedef std::vector<Point> VertexList;
 	typedef VertexList::const_iterator const_iterator;
 
 	/// Iterator by edges.
@@ -61,47 +98,124 @@ public:
 
 
 public:
-	Polygon() {}
+	Polygon() : cached(0), locateQueries(0), edgeQueries(0) {}
 	Polygon(std::list<Point> const &vertices);
+	Polygon(std::vector<Point> &&vertices);
 
-	Polygon(Polygon &&r) _NOEXCEPT { vertices.swap(r.vertices); }
+	Polygon(Polygon &&r) _NOEXCEPT : cached(0), locateQueries(0), edgeQueries(0) { swap(r); }
 
 protected:
 	Polygon(Polygon const &r) = default;
 
 public:
-	Polygon& operator=(Polygon &&r) _NOEXCEPT { vertices.swap(r.vertices); return *this; }
+	Polygon& operator=(Polygon &&r) _NOEXCEPT { swap(r); return *this; }
 
 	unsigned int numVertices() const { return vertices.size(); }
 
 	bool empty() const { return vertices.empty(); }
 
-	iterator begin() { return vertices.begin(); }
-	iterator end()   { return vertices.end(); }
 	const_iterator begin() const { return vertices.begin(); }
 	const_iterator end()   const { return vertices.end(); }
 
-	Point & back() { return vertices.back(); }
-	
+	Point const & operator[](unsigned idx) const { return vertices[idx]; }
+
 	ConstEdgeIterator edgeBegin() const { return ConstEdgeIterator(vertices.begin(), vertices); }
 	ConstEdgeIterator edgeEnd()   const { return ConstEdgeIterator(vertices.end(),   vertices); }
 
-	void addVertex(Point const &vertex) { vertices.push_back(vertex); }
-	void insertVertex(const_iterator at, Point const &vertex) { vertices.insert(at, vertex); }
-	void removeVertex(const_iterator at) { vertices.erase(at); }
+	/// Edge starting at vertex of given index.
+	ConstEdgeIterator edgeAt(unsigned idx) const { return ConstEdgeIterator(vertices.begin() + idx, vertices); }
+
+	void addVertex(Point const &vertex) { vertices.push_back(vertex); invalidate(); }
+	void insertVertex(const_iterator at, Point const &vertex) { vertices.insert(at, vertex); invalidate(); }
+	void removeVertex(const_iterator at) { vertices.erase(at); invalidate(); }
+	void setVertex(const_iterator at, Point const &vertex);
 	
 	/// Translate (move) by given vector
-	void translate(Vector const &v) { for ( Point &p : vertices ) p += v; }
+	void translate(Vector const &v);
 
 	/// Test if polygon is simple, i.e. has no self-intersections, including self-touches.
+	/*! O(n log n) for large polygons, see hasSelfIntersections_Sweep(), O(n^2) for small ones.
+	 */
 	bool isSimple() const;
 
+	/// Test if polygon is strictly convex, i.e. simple and turning in the same direction at
+	/// every vertex. Polygons with collinear neighbour edges or repeated vertices are not.
+	/*! O(n).
+	 */
+	bool isConvex() const;
+
 	bool isCcw() const;    ///< Test if direction is counterclockwise.
 	void makeCcw();        ///< Make direction counterclockwise.
 	Polygon toCcw() const; ///< Return counterclockwise copy.
 
+	/// Bounding box.
+	/*! \throw domain_error If polygon is empty.
+	 */
+	Rect const & boundingBox() const;
+
+	/// Area, positive for counterclockwise polygon and negative for clockwise.
+	/*! Meaningful for simple polygons only.
+	 *
+	 * \throw domain_error If polygon is empty.
+	 */
+	double signedArea() const;
+
+	/// \throw domain_error If polygon is empty.
+	double perimeter() const;
+
+	/// Locate point relative to polygon.
+	/*!
+	 * O(n), see locatePoint(). Polygons of many vertices queried many times build PointGrid,
+	 * and then queries are O(1) on average. The grid is dropped when vertices change.
+	 */
+	PointLocation locate(Point const &p) const;
+
+	/// Find the nearest edge within given distance.
+	/*!
+	 * \param strict  Consider only edges onto which the point projects, as distanceSqr_Strict().
+	 *
+	 * O(n), see nearestEdge(). Polygons of many vertices queried many times build EdgeTree,
+	 * and then queries are O(log n) on average. The tree is dropped when vertices change.
+	 */
+	EdgeDistance nearestEdge(Point const &p, double maxDistanceSqr = DBL_MAX, bool strict = false) const;
+
 protected:
+	/// Flags of valid cached properties
+	enum CachedProperty {
+		Cached_Metrics = 1,   ///< Bounding box, signed area and perimeter.
+		Cached_Simple  = 2,
+		Cached_Ccw     = 4,
+		Cached_Convex  = 8,
+	};
+
+	struct Properties {
+		Rect bbox;
+		double signedArea;
+		double perimeter;
+		bool simple;
+		bool ccw;
+		bool convex;
+	};
+
+	void invalidate() { cached = 0; pointGrid.reset(); locateQueries = 0; edgeTree.reset(); edgeQueries = 0; }
+	void computeMetrics() const;
+	bool testSimple() const;
+	bool testConvex() const;
+	bool testCcw() const;
+
+	void swap(Polygon &r) _NOEXCEPT;
+
+//Fields
 	VertexList vertices;
+
+	mutable Properties props;
+	mutable unsigned char cached;   ///< Combination of CachedProperty flags.
+
+	mutable std::shared_ptr<PointGrid const> pointGrid;   ///< Immutable, so shared by copies.
+	mutable unsigned locateQueries;                       ///< Number of locate() calls without grid.
+
+	mutable std::shared_ptr<EdgeTree const> edgeTree;     ///< Immutable, so shared by copies.
+	mutable unsigned edgeQueries;                         ///< Number of nearestEdge() calls without tree.
 };
 
 
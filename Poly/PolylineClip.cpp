@@ -0,0 +1,219 @@
+#include "PolylineClip.h"
+
+#include "Functions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+/// Number of polylines clipped by a thread at once.
+static size_t const ClipChunk = 1024;
+
+
+
+PolylineClipper::PolylineClipper(Polygon const &polygon)
+	: prepared(polygon)
+	, classifier(prepared.polygon())
+{}
+
+
+
+/// How side of polyline changes at split point.
+//
+enum SplitKind {
+	Split_Vertex,     ///< Polyline vertex off the boundary, the side stays.
+	Split_Crossing,   ///< Proper crossing of edge interiors, the side changes.
+	Split_Touch       ///< Other contact with boundary, the side is unknown.
+};
+
+
+
+/// Point of segment with its position along it.
+//
+struct SplitPoint {
+	double t;
+	Point p;
+	SplitKind kind;
+};
+
+
+
+/// Position of point lying on segment, 0 at s.p1 and 1 at s.p2.
+//
+static double positionOn(Segment const &s, Point const &p)
+{
+	Vector const v = s.toVector();
+	double const t = dotProduct(p - s.p1, v) / dotProduct(v, v);
+	return max(0.0, min(1.0, t));
+}
+
+
+
+PolylineClip PolylineClipper::clip(Polyline const &polyline) const
+{
+	PolylineClip rv;
+	if ( polyline.size() < 2 )
+		return rv;
+
+	Rect bbox(polyline.front(), polyline.front());
+	for ( Point const &p : polyline )
+		bbox.add(p);
+
+	bool const near = bbox.intersects(prepared.polygon().boundingBox());
+
+	vector<EdgeIntersection> isects;
+	if ( near )
+		isects = prepared.findPathIntersections(polyline.data(), unsigned(polyline.size()));
+
+	// Without crossings, polyline is on one side. Its vertices are not on the boundary then.
+	if ( isects.empty() ) {
+		bool const in = near && classifier.classify(polyline.front()) == PointLoc_Inside;
+		(in ? rv.inside : rv.outside).push_back(polyline);
+		return rv;
+	}
+
+	// Split segments at crossings, and join pieces of the same side. Pieces of one segment are
+	// joined without intermediate vertices. Only pieces after a touch of the boundary are
+	// classified by their middle points, others get the side from the previous piece.
+	Polygon const &polygon = prepared.polygon();
+	unsigned const n = polygon.numVertices();
+
+	bool sideKnown = false;
+	bool lastInside = false;
+
+	Polyline part;
+	bool partInside = false;
+	unsigned partSegment = 0;
+
+	auto const flush = [&]{
+		if ( ! part.empty() ) {
+			(partInside ? rv.inside : rv.outside).push_back(move(part));
+			part.clear();
+		}
+	};
+
+	vector<SplitPoint> splits;
+	auto isect = isects.cbegin();
+	for ( unsigned i = 0; i + 1 < polyline.size(); ++i ) {
+		Segment const seg(polyline[i], polyline[i+1]);
+
+		splits.clear();
+		splits.push_back(SplitPoint{0, seg.p1, Split_Vertex});
+		for ( ; isect != isects.cend() && isect->edge1 == i; ++isect ) {
+			Point const &p = isect->p1;
+			Point const &a = polygon[isect->edge2];
+			Point const &b = polygon[isect->edge2 + 1 < n ? isect->edge2 + 1 : 0];
+			bool const crossing = isect->shape == Isect_Point &&
+			                      ! (p == seg.p1 || p == seg.p2 || p == a || p == b);
+
+			splits.push_back(SplitPoint{positionOn(seg, p), p,
+			                            crossing ? Split_Crossing : Split_Touch});
+			if ( isect->shape == Isect_Segment )
+				splits.push_back(SplitPoint{positionOn(seg, isect->p2), isect->p2, Split_Touch});
+		}
+		splits.push_back(SplitPoint{1, seg.p2, Split_Vertex});
+
+		if ( seg.p1 == seg.p2 )
+			continue;
+
+		stable_sort(splits.begin(), splits.end(),
+		            [](SplitPoint const &s1, SplitPoint const &s2) { return s1.t < s2.t; });
+
+		for ( size_t k = 0; k + 1 < splits.size(); ++k ) {
+			Point const &p = splits[k].p, &q = splits[k+1].p;
+			SplitKind const kind = splits[k].kind;
+
+			bool in;
+			if ( sideKnown && kind != Split_Touch )
+				in = kind == Split_Crossing ? ! lastInside : lastInside;
+			else if ( p == q ) {
+				sideKnown = false;
+				continue;
+			}
+			else
+				in = classifier.classify(p + 0.5 * (q - p)) != PointLoc_Outside;
+
+			sideKnown = true;
+			lastInside = in;
+			if ( p == q )
+				continue;
+
+			if ( ! part.empty() && in == partInside ) {
+				if ( partSegment == i )
+					part.back() = q;
+				else
+					part.push_back(q);
+			}
+			else {
+				flush();
+				part.push_back(p);
+				part.push_back(q);
+				partInside = in;
+			}
+			partSegment = i;
+		}
+	}
+	flush();
+
+	return rv;
+}
+
+
+
+vector<PolylineClip> PolylineClipper::clip(vector<Polyline> const &polylines, unsigned threads) const
+{
+	vector<PolylineClip> rv(polylines.size());
+
+	size_t const count = polylines.size();
+	size_t const numChunks = (count + ClipChunk - 1) / ClipChunk;
+	atomic<size_t> nextChunk(0);
+
+	auto const worker = [&]{
+		for ( size_t chunk; (chunk = nextChunk++) < numChunks; ) {
+			size_t const end = min(count, (chunk + 1) * ClipChunk);
+			for ( size_t i = chunk * ClipChunk; i < end; ++i )
+				rv[i] = clip(polylines[i]);
+		}
+	};
+
+	if ( threads == 0 )
+		threads = thread::hardware_concurrency();
+	threads = (unsigned)max<size_t>(1, min<size_t>(threads, numChunks));
+
+	vector<future<void>> helpers;
+	for ( unsigned t = 1; t < threads; ++t )
+		helpers.push_back(async(launch::async, worker));
+	worker();
+	for ( auto &helper : helpers )
+		helper.get();
+
+	return rv;
+}
+
+
+
+PolylineClip clipPolyline(Polyline const &polyline, Polygon const &polygon)
+{
+	return PolylineClipper(polygon).clip(polyline);
+}
+
+
+
+vector<PolylineClip> clipPolylines(vector<Polyline> const &polylines, Polygon const &polygon,
+                                   unsigned threads)
+{
+	return PolylineClipper(polygon).clip(polylines, threads);
+}
+
+
+
+} // namespace poly
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Point.h"
+#include "PointClassifier.h"
+#include "Polygon.h"
+#include "PreparedPolygon.h"
+
+#include <cstddef>
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Polyline (open path) given by vertices.
+typedef std::vector<Point> Polyline;
+
+/// Parts of polyline inside and outside of polygon, in order along polyline.
+/*!
+ * Parts lying on polygon boundary are inside, as polygon is closed.
+ */
+struct PolylineClip {
+	std::vector<Polyline> inside;
+	std::vector<Polyline> outside;
+};
+
+
+
+/// Polygon prepared for clipping many polylines.
+/*!
+ * Crossings of polyline with polygon boundary are found through R-tree of polygon edges of
+ * PreparedPolygon, which is O(m log n + k) for polyline of m segments. The side of polyline
+ * changes at each proper crossing of edge interiors. Pieces following other contacts with the
+ * boundary (at vertices or along edges), and polylines without crossings, are classified by
+ * middle points with PointClassifier. Polylines not touching the bounding box of polygon are
+ * rejected at once. Memory is O(n).
+ *
+ * The object is not modified after construction, so it can be used from several threads.
+ */
+class PolylineClipper
+{
+public:
+	/// \throw domain_error If polygon is empty or self-intersecting.
+	explicit PolylineClipper(Polygon const &polygon);
+
+	/// Clip polyline. Polylines of less than 2 vertices give empty result.
+	PolylineClip clip(Polyline const &polyline) const;
+
+	/// Clip array of polylines.
+	/*!
+	 * Polylines are split into chunks processed by given number of threads.
+	 *
+	 * \param threads  Number of threads, including the calling one. 0 means hardware
+	 *                 concurrency.
+	 *
+	 * \return Results for each polyline, in the same order.
+	 */
+	std::vector<PolylineClip> clip(std::vector<Polyline> const &polylines, unsigned threads = 1) const;
+
+private:
+	PreparedPolygon prepared;
+	PointClassifier classifier;
+};
+
+
+
+/// Clip polyline to polygon.
+/*! \see PolylineClipper
+ */
+PolylineClip clipPolyline(Polyline const &polyline, Polygon const &polygon);
+
+/// Clip many polylines to the same polygon, preparing it once.
+/*! \see PolylineClipper::clip(std::vector<Polyline> const &, unsigned) const
+ */
+std::vector<PolylineClip> clipPolylines(std::vector<Polyline> const &polylines,
+                                        Polygon const &polygon, unsigned threads = 1);
+
+
+
+} // namespace poly
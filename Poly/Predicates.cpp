@@ -0,0 +1,176 @@
+#include "Predicates.h"
+
+
+
+namespace poly {
+namespace predicates {
+namespace detail {
+
+
+
+/*
+ * Expansion is a sum of non-overlapping doubles, stored in order of increasing magnitude.
+ * Sign of expansion is the sign of its largest component.
+ */
+
+namespace {
+
+
+
+/// x + y = a + b exactly, x = fl(a + b).
+//
+inline void twoSum(double a, double b, double &x, double &y)
+{
+	x = a + b;
+	double const bVirt = x - a;
+	double const aVirt = x - bVirt;
+	y = (a - aVirt) + (b - bVirt);
+}
+
+
+
+/// x + y = a - b exactly, x = fl(a - b).
+//
+inline void twoDiff(double a, double b, double &x, double &y)
+{
+	x = a - b;
+	double const bVirt = a - x;
+	double const aVirt = x + bVirt;
+	y = (a - aVirt) + (bVirt - b);
+}
+
+
+
+/// Split into halves of 26 bits, a = hi + lo.
+//
+inline void split(double a, double &hi, double &lo)
+{
+	double const Splitter = 134217729.0;   // 2^27 + 1
+	double const c = Splitter * a;
+	double const aBig = c - a;
+	hi = c - aBig;
+	lo = a - hi;
+}
+
+
+
+/// x + y = a * b exactly, x = fl(a * b).
+//
+inline void twoProduct(double a, double b, double &x, double &y)
+{
+	x = a * b;
+	double aHi, aLo, bHi, bLo;
+	split(a, aHi, aLo);
+	split(b, bHi, bLo);
+	double const err1 = x - aHi * bHi;
+	double const err2 = err1 - aLo * bHi;
+	double const err3 = err2 - aHi * bLo;
+	y = aLo * bLo - err3;
+}
+
+
+
+/// h = e * b, zero components eliminated.
+/*! \return Length of h, at most 2 * eLen.
+ */
+int scaleExpansion(int eLen, double const *e, double b, double *h)
+{
+	int hLen = 0;
+	double q, hh;
+
+	twoProduct(e[0], b, q, hh);
+	if ( hh != 0 )
+		h[hLen++] = hh;
+
+	for ( int i = 1; i < eLen; ++i ) {
+		double product1, product0, sum;
+		twoProduct(e[i], b, product1, product0);
+		twoSum(q, product0, sum, hh);
+		if ( hh != 0 )
+			h[hLen++] = hh;
+		twoSum(product1, sum, q, hh);   // |product1| >= |sum|
+		if ( hh != 0 )
+			h[hLen++] = hh;
+	}
+
+	if ( q != 0 || hLen == 0 )
+		h[hLen++] = q;
+	return hLen;
+}
+
+
+
+/// h = e + f, zero components eliminated.
+/*! \return Length of h, at most eLen + fLen.
+ */
+int expansionSum(int eLen, double const *e, int fLen, double const *f, double *h)
+{
+	// Merge components by magnitude, accumulating with twoSum
+	double q = 0;
+	int hLen = 0;
+	int i = 0, j = 0;
+
+	while ( i < eLen || j < fLen ) {
+		double next;
+		if ( j == fLen || (i < eLen && std::fabs(e[i]) < std::fabs(f[j])) )
+			next = e[i++];
+		else
+			next = f[j++];
+
+		double sum, hh;
+		twoSum(q, next, sum, hh);
+		if ( hh != 0 )
+			h[hLen++] = hh;
+		q = sum;
+	}
+
+	if ( q != 0 || hLen == 0 )
+		h[hLen++] = q;
+	return hLen;
+}
+
+
+
+/// e1 * e2 for 2-component expansions.
+/*! \return Length of h, at most 8.
+ */
+int product(double const *e1, double const *e2, double *h)
+{
+	double t0[4], t1[4];
+	int const len0 = scaleExpansion(2, e1, e2[0], t0);
+	int const len1 = scaleExpansion(2, e1, e2[1], t1);
+	return expansionSum(len0, t0, len1, t1, h);
+}
+
+
+
+} // namespace
+
+
+
+int crossSignExact(Point const &a, Point const &b, Point const &c, Point const &d)
+{
+	double bax[2], bay[2], dcx[2], dcy[2];
+	twoDiff(b.x, a.x, bax[1], bax[0]);
+	twoDiff(b.y, a.y, bay[1], bay[0]);
+	twoDiff(d.x, c.x, dcx[1], dcx[0]);
+	twoDiff(d.y, c.y, dcy[1], dcy[0]);
+
+	double left[8], right[8];
+	int const leftLen  = product(bax, dcy, left);
+	int rightLen = product(bay, dcx, right);
+	for ( int i = 0; i < rightLen; ++i )
+		right[i] = -right[i];
+
+	double det[16];
+	int const detLen = expansionSum(leftLen, left, rightLen, right, det);
+
+	double const top = det[detLen - 1];
+	return top > 0 ? 1 : (top < 0 ? -1 : 0);
+}
+
+
+
+} // namespace detail
+} // namespace predicates
+} // namespace poly
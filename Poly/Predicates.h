@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Point.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+
+
+namespace poly {
+
+
+
+/// Robust geometric predicates.
+/*!
+ * Signs of determinants are computed exactly for any double coordinates. Determinant is first
+ * evaluated in floating point; only if the result is smaller than its error bound, it is
+ * recomputed exactly with floating-point expansions (J. R. Shewchuk, "Adaptive Precision
+ * Floating-Point Arithmetic and Fast Robust Geometric Predicates").
+ *
+ * Arithmetic must be IEEE double with round-to-nearest, as with /fp:precise and SSE2.
+ */
+namespace predicates {
+
+namespace detail {
+
+double const Epsilon = std::numeric_limits<double>::epsilon() / 2;
+
+/// Relative error bound of floating-point determinant of two products of differences.
+double const CrossErrorBound = (3 + 16 * Epsilon) * Epsilon;
+
+int crossSignExact(Point const &a, Point const &b, Point const &c, Point const &d);
+
+
+/// Full 128-bit product of unsigned 64-bit integers.
+//
+inline void multiplyWide(uint64_t a, uint64_t b, uint64_t &hi, uint64_t &lo)
+{
+	uint64_t const aLo = a & 0xFFFFFFFF, aHi = a >> 32;
+	uint64_t const bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+
+	uint64_t const ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+	uint64_t const mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+
+	lo = (mid << 32) | (ll & 0xFFFFFFFF);
+	hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+}
+
+} // namespace detail
+
+
+
+/// Exact sign of a*b - c*d for 64-bit integers.
+/*!
+ * \return 1, -1 or 0.
+ */
+inline int productDiffSign(int64_t a, int64_t b, int64_t c, int64_t d)
+{
+	int const s1 = (a > 0) - (a < 0), s2 = (b > 0) - (b < 0);
+	int const s3 = (c > 0) - (c < 0), s4 = (d > 0) - (d < 0);
+	int const left = s1 * s2, right = s3 * s4;
+
+	if ( left != right )
+		return left > right ? 1 : -1;
+	if ( left == 0 )
+		return 0;
+
+	// Same sign: compare magnitudes
+	uint64_t const ua = a < 0 ? 0 - uint64_t(a) : uint64_t(a), ub = b < 0 ? 0 - uint64_t(b) : uint64_t(b);
+	uint64_t const uc = c < 0 ? 0 - uint64_t(c) : uint64_t(c), ud = d < 0 ? 0 - uint64_t(d) : uint64_t(d);
+
+	uint64_t hi1, lo1, hi2, lo2;
+	detail::multiplyWide(ua, ub, hi1, lo1);
+	detail::multiplyWide(uc, ud, hi2, lo2);
+
+	int const cmp = hi1 != hi2 ? (hi1 > hi2 ? 1 : -1) : (lo1 != lo2 ? (lo1 > lo2 ? 1 : -1) : 0);
+	return left * cmp;
+}
+
+
+
+/// Exact sign of cross product (b - a) x (d - c).
+/*!
+ * \return 1, -1 or 0.
+ */
+inline int crossSign(Point const &a, Point const &b, Point const &c, Point const &d)
+{
+	double const left  = (b.x - a.x) * (d.y - c.y);
+	double const right = (b.y - a.y) * (d.x - c.x);
+	double const det = left - right;
+	double const errBound = detail::CrossErrorBound * (std::fabs(left) + std::fabs(right));
+
+	if ( det > errBound )
+		return 1;
+	if ( -det > errBound )
+		return -1;
+	return detail::crossSignExact(a, b, c, d);
+}
+
+/// Exact sign of cross product (b - a) x (c - a).
+//
+inline int orientSign(Point const &a, Point const &b, Point const &c)
+{ return crossSign(a, b, a, c); }
+
+} // namespace predicates
+
+
+
+} // namespace poly
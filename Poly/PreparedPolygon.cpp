@@ -0,0 +1,116 @@
+#include "PreparedPolygon.h"
+
+#include "Functions.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+static Rect segmentBox(Segment const &s)
+{
+	return Rect(Point(min(s.p1.x, s.p2.x), min(s.p1.y, s.p2.y)),
+	            Point(max(s.p1.x, s.p2.x), max(s.p1.y, s.p2.y)));
+}
+
+
+
+PreparedPolygon::PreparedPolygon(Polygon const &polygon)
+{
+	if ( polygon.empty() )
+		throw domain_error("Empty polygon");
+	if ( ! polygon.isSimple() )
+		throw domain_error("Self-intersecting polygon");
+
+	ccw = polygon.toCcw();
+
+	// Fill the cache now, so that const access from several threads does not modify it
+	ccw.boundingBox();
+	ccw.isSimple();
+	ccw.isCcw();
+
+	unsigned idx = 0;
+	for ( auto edge = ccw.edgeBegin(); edge != ccw.edgeEnd(); ++edge, ++idx ) {
+		Segment const seg = *edge;
+		if ( ! (seg.p1 == seg.p2) )
+			edgeIndex.insert(segmentBox(seg), idx);
+	}
+}
+
+
+
+vector<EdgeIntersection> PreparedPolygon::findEdgeIntersections(Polygon const &other,
+                                                                unsigned preparedIdx) const
+{
+	vector<EdgeIntersection> rv;
+
+	if ( other.empty() || ! ccw.boundingBox().intersects(other.boundingBox()) )
+		return rv;
+
+	unsigned otherEdge = 0;
+	for ( auto edge = other.edgeBegin(); edge != other.edgeEnd(); ++edge, ++otherEdge )
+		findSegmentIntersections(*edge, otherEdge, preparedIdx, rv);
+
+	sortIntersections(rv);
+	return rv;
+}
+
+
+
+vector<EdgeIntersection> PreparedPolygon::findPathIntersections(Point const *path,
+                                                                unsigned numVertices) const
+{
+	vector<EdgeIntersection> rv;
+
+	for ( unsigned i = 0; i + 1 < numVertices; ++i )
+		findSegmentIntersections(Segment(path[i], path[i+1]), i, 1, rv);
+
+	sortIntersections(rv);
+	return rv;
+}
+
+
+
+/// Append intersections of edges with segment of other polygon or path.
+//
+void PreparedPolygon::findSegmentIntersections(Segment const &otherSeg, unsigned otherEdge,
+                                               unsigned preparedIdx,
+                                               vector<EdgeIntersection> &rv) const
+{
+	if ( otherSeg.p1 == otherSeg.p2 )
+		return;
+
+	edgeIndex.query(segmentBox(otherSeg), [&](Rect const &, unsigned preparedEdge) {
+		Segment const preparedSeg(ccw[preparedEdge], ccw[(preparedEdge + 1) % ccw.numVertices()]);
+
+		// Segments are passed in the same order as by other methods, for identical results
+		EdgeIntersection isect;
+		isect.shape = preparedIdx == 0 ? intersect(preparedSeg, otherSeg, isect.p1, isect.p2)
+		                               : intersect(otherSeg, preparedSeg, isect.p1, isect.p2);
+		if ( isect.shape == Isect_Empty )
+			return;
+
+		isect.edge1 = preparedIdx == 0 ? preparedEdge : otherEdge;
+		isect.edge2 = preparedIdx == 0 ? otherEdge : preparedEdge;
+		rv.push_back(isect);
+	});
+}
+
+
+
+void PreparedPolygon::sortIntersections(vector<EdgeIntersection> &isects)
+{
+	sort(isects.begin(), isects.end(), [](EdgeIntersection const &i1, EdgeIntersection const &i2) {
+		return i1.edge1 < i2.edge1 || (i1.edge1 == i2.edge1 && i1.edge2 < i2.edge2);
+	});
+}
+
+
+
+} // namespace poly
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Polygon.h"
+#include "RTree.h"
+#include "EdgeIntersections.h"
+
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Polygon prepared for repeated boolean operations with other polygons.
+/*!
+ * Preparation checks that polygon is simple, makes its counterclockwise copy and builds
+ * R-tree of its edges. This is done once, and then operations with other polygons skip it
+ * for this operand. Edge intersections are found through the R-tree, which is
+ * O(m log n + k) for other polygon of m edges, instead of O((n + m + k) log(n + m)) of sweep.
+ *
+ * The object is not modified after construction, so it can be used from several threads.
+ *
+ * \see Boolean operations in Boolean.h.
+ */
+class PreparedPolygon
+{
+public:
+	/// \throw domain_error If polygon is empty or self-intersecting.
+	explicit PreparedPolygon(Polygon const &polygon);
+
+	PreparedPolygon(PreparedPolygon &&r) _NOEXCEPT
+		: ccw(std::move(r.ccw)), edgeIndex(std::move(r.edgeIndex)) {}
+
+	/// Counterclockwise copy of original polygon.
+	Polygon const & polygon() const { return ccw; }
+
+	/// Find intersections of edges of counterclockwise copy with edges of other polygon.
+	/*!
+	 * \param other        Other polygon.
+	 * \param preparedIdx  Position of this polygon in pair, 0 or 1. Edge indices and
+	 *                     intersection points are given as for findEdgeIntersections_Sweep()
+	 *                     called for the pair.
+	 *
+	 * \return Intersections ordered by (edge1, edge2).
+	 */
+	std::vector<EdgeIntersection> findEdgeIntersections(Polygon const &other,
+	                                                    unsigned preparedIdx) const;
+
+	/// Find intersections of edges of counterclockwise copy with segments of open path.
+	/*!
+	 * Segment i goes from path[i] to path[i+1], there is no closing segment.
+	 *
+	 * \return Intersections ordered by (segment, edge), with segment indices in edge1.
+	 */
+	std::vector<EdgeIntersection> findPathIntersections(Point const *path,
+	                                                    unsigned numVertices) const;
+
+private:
+	void findSegmentIntersections(Segment const &otherSeg, unsigned otherEdge, unsigned preparedIdx,
+	                              std::vector<EdgeIntersection> &rv) const;
+	static void sortIntersections(std::vector<EdgeIntersection> &isects);
+
+	Polygon ccw;
+	RTree<unsigned> edgeIndex;   ///< Bounding boxes of edges of ccw, values are edge indices.
+};
+
+
+
+} // namespace poly
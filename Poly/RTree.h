@@ -0,0 +1,453 @@
+#pragma once
+
+#include "Rect.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Dynamic R-tree of values with bounding rectangles (Guttman, quadratic split).
+/*!
+ * Insertion and removal are O(log n) on average. Query visits only subtrees whose rectangles
+ * intersect the query rectangle.
+ *
+ * The tree does not own or watch the objects behind values. When an object changes its
+ * bounding rectangle, the client must remove the value with the old rectangle and insert it
+ * with the new one.
+ *
+ * \tparam Value  Default constructible, copyable, equality comparable. The same value can be
+ *                inserted several times, but then remove() removes one of them.
+ */
+template <typename Value>
+class RTree
+{
+public:
+	RTree() : root(new Node(0)), _size(0) {}
+
+	RTree(RTree &&r) _NOEXCEPT : _size(0) { swap(r); }
+	RTree& operator=(RTree &&r) _NOEXCEPT { swap(r); return *this; }
+
+	/// Build tree of given values at once, by Sort-Tile-Recursive packing.
+	/*!
+	 * Values are sorted into full nodes of neighbouring rectangles, level by level, which is
+	 * O(n log n) and gives tighter nodes and faster queries than inserting values one by one.
+	 * The tree can be modified afterwards as usual.
+	 */
+	static RTree bulkLoad(std::vector<std::pair<Rect, Value>> const &values);
+
+	unsigned size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	void clear() { root.reset(new Node(0)); _size = 0; }
+
+	void insert(Rect const &rect, Value const &value);
+
+	/// Remove value inserted with given rectangle.
+	/*! \return False if there is no such value.
+	 */
+	bool remove(Rect const &rect, Value const &value);
+
+	/// Visit values whose rectangles intersect given rectangle.
+	/*!
+	 * \param visit  Functor void(Rect const &, Value const &).
+	 */
+	template <typename Visitor>
+	void query(Rect const &rect, Visitor visit) const { query(*root, rect, visit); }
+
+	/// Visit values whose rectangles contain given point.
+	/*!
+	 * \param visit  Functor void(Rect const &, Value const &).
+	 */
+	template <typename Visitor>
+	void query(Point const &p, Visitor visit) const { query(*root, Rect(p, p), visit); }
+
+	void swap(RTree &r) _NOEXCEPT { root.swap(r.root); std::swap(_size, r._size); }
+
+private:
+	enum { MaxEntries = 16, MinEntries = 6 };
+
+	struct Node;
+
+	/// Entry of node: child node for internal nodes, value for leaves.
+	struct Entry {
+		Rect rect;
+		std::unique_ptr<Node> child;
+		Value value;
+
+		Entry() {}
+		Entry(Rect const &rect, Value const &value) : rect(rect), value(value) {}
+		Entry(Rect const &rect, std::unique_ptr<Node> &&child) : rect(rect), child(std::move(child)) {}
+		Entry(Entry &&r) : rect(r.rect), child(std::move(r.child)), value(r.value) {}
+		Entry& operator=(Entry &&r) { rect = r.rect; child = std::move(r.child); value = r.value; return *this; }
+	};
+
+	struct Node {
+		unsigned level;   ///< 0 for leaves.
+		std::vector<Entry> entries;
+
+		explicit Node(unsigned level) : level(level) { entries.reserve(MaxEntries + 1); }
+
+		bool leaf() const { return level == 0; }
+		Rect boundingBox() const;
+	};
+
+	static double area(Rect const &r) { return r.width() * r.height(); }
+	static Rect united(Rect r, Rect const &r2) { r.add(r2); return r; }
+	static double enlargement(Rect const &r, Rect const &add) { return area(united(r, add)) - area(r); }
+
+	void insert(Entry &&entry, unsigned level);
+	std::unique_ptr<Node> split(Node &node);
+	static std::vector<Entry> pack(std::vector<Entry> &&entries, unsigned level);
+	bool findLeaf(Node &node, Rect const &rect, Value const &value,
+	              std::vector<std::pair<Node *, unsigned>> &path);
+	static void takeLeafEntries(Node &node, std::vector<Entry> &entries);
+
+	template <typename Visitor>
+	static void query(Node const &node, Rect const &rect, Visitor &visit);
+
+//Fields
+	std::unique_ptr<Node> root;
+	unsigned _size;
+};
+
+
+
+template <typename Value>
+Rect RTree<Value>::Node::boundingBox() const
+{
+	Rect r = entries.front().rect;
+	for ( auto const &e : entries )
+		r.add(e.rect);
+	return r;
+}
+
+
+
+template <typename Value>
+RTree<Value> RTree<Value>::bulkLoad(std::vector<std::pair<Rect, Value>> const &values)
+{
+	RTree rv;
+
+	std::vector<Entry> entries;
+	entries.reserve(values.size());
+	for ( auto const &v : values )
+		entries.emplace_back(v.first, v.second);
+
+	unsigned level = 0;
+	while ( entries.size() > MaxEntries )
+		entries = pack(std::move(entries), level++);
+
+	rv.root.reset(new Node(level));
+	for ( auto &e : entries )
+		rv.root->entries.push_back(std::move(e));
+	rv._size = unsigned(values.size());
+	return rv;
+}
+
+
+
+/// Pack entries into nodes of given level by Sort-Tile-Recursive method.
+/*!
+ * Entries are sorted by x of centers and cut into vertical slices, then each slice is sorted
+ * by y and cut into nodes of MaxEntries.
+ *
+ * \return Entries of the next level up, one per node.
+ */
+template <typename Value>
+std::vector<typename RTree<Value>::Entry> RTree<Value>::pack(std::vector<Entry> &&entries,
+                                                             unsigned level)
+{
+	size_t const numNodes = (entries.size() + MaxEntries - 1) / MaxEntries;
+	size_t const numSlices = size_t(std::ceil(std::sqrt(double(numNodes))));
+	size_t const sliceSize = ((numNodes + numSlices - 1) / numSlices) * MaxEntries;
+
+	auto const centerX = [](Entry const &e) { return e.rect.pMin.x + e.rect.pMax.x; };
+	auto const centerY = [](Entry const &e) { return e.rect.pMin.y + e.rect.pMax.y; };
+
+	std::sort(entries.begin(), entries.end(),
+	          [&](Entry const &e1, Entry const &e2) { return centerX(e1) < centerX(e2); });
+
+	std::vector<Entry> parents;
+	parents.reserve(numNodes);
+
+	for ( size_t slice = 0; slice < entries.size(); slice += sliceSize ) {
+		auto const sliceBegin = entries.begin() + slice;
+		auto const sliceEnd = entries.begin() + std::min(entries.size(), slice + sliceSize);
+		std::sort(sliceBegin, sliceEnd,
+		          [&](Entry const &e1, Entry const &e2) { return centerY(e1) < centerY(e2); });
+
+		for ( auto it = sliceBegin; it != sliceEnd; ) {
+			std::unique_ptr<Node> node(new Node(level));
+			for ( auto const nodeEnd = it + std::min<ptrdiff_t>(MaxEntries, sliceEnd - it); it != nodeEnd; ++it )
+				node->entries.push_back(std::move(*it));
+			Rect const rect = node->boundingBox();
+			parents.emplace_back(rect, std::move(node));
+		}
+	}
+
+	return parents;
+}
+
+
+
+template <typename Value>
+void RTree<Value>::insert(Rect const &rect, Value const &value)
+{
+	insert(Entry(rect, value), 0);
+	++_size;
+}
+
+
+
+/// Insert entry into node of given level, splitting overflowed nodes up to the root.
+//
+template <typename Value>
+void RTree<Value>::insert(Entry &&entry, unsigned level)
+{
+	// Choose path: child needing least enlargement, ties resolved by smaller area
+	std::vector<Node *> path(1, root.get());
+	while ( path.back()->level > level ) {
+		Node &node = *path.back();
+		Entry *best = nullptr;
+		double bestEnlargement = 0, bestArea = 0;
+		for ( auto &e : node.entries ) {
+			double const enl = enlargement(e.rect, entry.rect);
+			double const a = area(e.rect);
+			if ( ! best || enl < bestEnlargement || (enl == bestEnlargement && a < bestArea) ) {
+				best = &e;
+				bestEnlargement = enl;
+				bestArea = a;
+			}
+		}
+		best->rect.add(entry.rect);
+		path.push_back(best->child.get());
+	}
+
+	path.back()->entries.push_back(std::move(entry));
+
+	// Split overflowed nodes bottom-up
+	for ( size_t i = path.size(); i-- > 0; ) {
+		Node &node = *path[i];
+		if ( node.entries.size() <= MaxEntries )
+			break;
+
+		std::unique_ptr<Node> sibling = split(node);
+		Rect const siblingRect = sibling->boundingBox();
+
+		if ( i == 0 ) {
+			std::unique_ptr<Node> newRoot(new Node(node.level + 1));
+			Rect const rootRect = node.boundingBox();
+			newRoot->entries.emplace_back(rootRect, std::move(root));
+			newRoot->entries.emplace_back(siblingRect, std::move(sibling));
+			root = std::move(newRoot);
+		}
+		else {
+			Node &parent = *path[i-1];
+			for ( auto &e : parent.entries ) {
+				if ( e.child.get() == &node ) {
+					e.rect = node.boundingBox();
+					break;
+				}
+			}
+			parent.entries.emplace_back(siblingRect, std::move(sibling));
+		}
+	}
+}
+
+
+
+/// Split overflowed node by quadratic algorithm.
+/*!
+ * \return New sibling node with part of entries.
+ */
+template <typename Value>
+std::unique_ptr<typename RTree<Value>::Node> RTree<Value>::split(Node &node)
+{
+	std::vector<Entry> rest;
+	rest.swap(node.entries);
+	node.entries.reserve(MaxEntries + 1);
+
+	std::unique_ptr<Node> sibling(new Node(node.level));
+
+	// Seeds: pair wasting the most area if put together
+	size_t seed1 = 0, seed2 = 1;
+	double worst = -1;
+	for ( size_t i = 0; i < rest.size(); ++i )
+		for ( size_t j = i + 1; j < rest.size(); ++j ) {
+			double const d = area(united(rest[i].rect, rest[j].rect)) - area(rest[i].rect)
+			                                                          - area(rest[j].rect);
+			if ( d > worst ) {
+				worst = d;
+				seed1 = i;  seed2 = j;
+			}
+		}
+
+	Rect rect1 = rest[seed1].rect, rect2 = rest[seed2].rect;
+	node.entries.push_back(std::move(rest[seed1]));
+	sibling->entries.push_back(std::move(rest[seed2]));
+	rest.erase(rest.begin() + seed2);   // seed2 > seed1
+	rest.erase(rest.begin() + seed1);
+
+	while ( ! rest.empty() ) {
+		// If one group needs all the rest to reach minimum, give them all
+		if ( node.entries.size() + rest.size() <= MinEntries ||
+		     sibling->entries.size() + rest.size() <= MinEntries ) {
+			Node &group = node.entries.size() < sibling->entries.size() ? node : *sibling;
+			for ( auto &e : rest )
+				group.entries.push_back(std::move(e));
+			break;
+		}
+
+		// Next entry: one with the greatest preference for a group
+		size_t next = 0;
+		double maxDiff = -1, d1 = 0, d2 = 0;
+		for ( size_t i = 0; i < rest.size(); ++i ) {
+			double const e1 = enlargement(rect1, rest[i].rect);
+			double const e2 = enlargement(rect2, rest[i].rect);
+			double const diff = e1 > e2 ? e1 - e2 : e2 - e1;
+			if ( diff > maxDiff ) {
+				maxDiff = diff;
+				next = i;
+				d1 = e1;  d2 = e2;
+			}
+		}
+
+		bool toFirst;
+		if ( d1 != d2 )
+			toFirst = d1 < d2;
+		else if ( area(rect1) != area(rect2) )
+			toFirst = area(rect1) < area(rect2);
+		else
+			toFirst = node.entries.size() <= sibling->entries.size();
+
+		if ( toFirst ) {
+			rect1.add(rest[next].rect);
+			node.entries.push_back(std::move(rest[next]));
+		}
+		else {
+			rect2.add(rest[next].rect);
+			sibling->entries.push_back(std::move(rest[next]));
+		}
+		rest.erase(rest.begin() + next);
+	}
+
+	return sibling;
+}
+
+
+
+template <typename Value>
+bool RTree<Value>::remove(Rect const &rect, Value const &value)
+{
+	std::vector<std::pair<Node *, unsigned>> path;   // Node and index of entry in it
+	if ( ! findLeaf(*root, rect, value, path) )
+		return false;
+
+	Node *const leaf = path.back().first;
+	leaf->entries.erase(leaf->entries.begin() + path.back().second);
+	--_size;
+
+	// Condense tree: remove underflowed nodes, keeping their values for reinsertion,
+	// and tighten rectangles of the rest
+	std::vector<Entry> orphans;
+	for ( size_t i = path.size() - 1; i > 0; --i ) {
+		Node &node = *path[i].first;
+		Node &parent = *path[i-1].first;
+		unsigned const idxInParent = path[i-1].second;
+
+		if ( node.entries.size() < MinEntries ) {
+			takeLeafEntries(node, orphans);
+			parent.entries.erase(parent.entries.begin() + idxInParent);   // Deletes node
+		}
+		else
+			parent.entries[idxInParent].rect = node.boundingBox();
+	}
+
+	// Shorten tree
+	while ( ! root->leaf() && root->entries.size() == 1 ) {
+		std::unique_ptr<Node> child = std::move(root->entries.front().child);
+		root = std::move(child);
+	}
+	if ( ! root->leaf() && root->entries.empty() )
+		root.reset(new Node(0));
+
+	for ( auto &e : orphans )
+		insert(std::move(e), 0);
+
+	return true;
+}
+
+
+
+/// Find leaf entry with given rectangle and value.
+/*!
+ * \param[out] path  Nodes from root to leaf, each with index of entry taken in it.
+ */
+template <typename Value>
+bool RTree<Value>::findLeaf(Node &node, Rect const &rect, Value const &value,
+                            std::vector<std::pair<Node *, unsigned>> &path)
+{
+	for ( unsigned i = 0; i < node.entries.size(); ++i ) {
+		Entry &e = node.entries[i];
+		if ( ! e.rect.contains(rect) )
+			continue;
+
+		path.emplace_back(&node, i);
+
+		if ( node.leaf() ) {
+			if ( e.value == value )
+				return true;
+		}
+		else if ( findLeaf(*e.child, rect, value, path) )
+			return true;
+
+		path.pop_back();
+	}
+
+	return false;
+}
+
+
+
+/// Move values from subtree to given list.
+//
+template <typename Value>
+void RTree<Value>::takeLeafEntries(Node &node, std::vector<Entry> &entries)
+{
+	for ( auto &e : node.entries ) {
+		if ( node.leaf() )
+			entries.push_back(std::move(e));
+		else
+			takeLeafEntries(*e.child, entries);
+	}
+}
+
+
+
+template <typename Value>
+template <typename Visitor>
+void RTree<Value>::query(Node const &node, Rect const &rect, Visitor &visit)
+{
+	for ( auto const &e : node.entries ) {
+		if ( ! e.rect.intersects(rect) )
+			continue;
+
+		if ( node.leaf() )
+			visit(e.rect, e.value);
+		else
+			query(*e.child, rect, visit);
+	}
+}
+
+
+
+} // namespace poly
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Point.h"
+#include "Vector.h"
+
+
+namespace poly {
+
+
+
+/// Axis-aligned rectangle.
+/*! Edges belong to rectangle.
+ */
+class Rect
+{
+public:
+	Point pMin, pMax;   ///< Corners with minimal and maximal coordinates.
+
+//
+	Rect() {}
+	Rect(Point const &pMin, Point const &pMax) : pMin(pMin), pMax(pMax) {}
+
+	double width()  const { return pMax.x - pMin.x; }
+	double height() const { return pMax.y - pMin.y; }
+
+	bool contains(Point const &p) const
+		{ return pMin.x <= p.x && p.x <= pMax.x && pMin.y <= p.y && p.y <= pMax.y; }
+
+	bool contains(Rect const &r) const { return contains(r.pMin) && contains(r.pMax); }
+
+	bool intersects(Rect const &r) const {
+		return pMin.x <= r.pMax.x && r.pMin.x <= pMax.x &&
+		       pMin.y <= r.pMax.y && r.pMin.y <= pMax.y;
+	}
+
+	/// Extend to contain point.
+	void add(Point const &p) {
+		if ( p.x < pMin.x ) pMin.x = p.x;
+		if ( p.x > pMax.x ) pMax.x = p.x;
+		if ( p.y < pMin.y ) pMin.y = p.y;
+		if ( p.y > pMax.y ) pMax.y = p.y;
+	}
+
+	/// Extend to contain rectangle.
+	void add(Rect const &r) { add(r.pMin); add(r.pMax); }
+
+	void translate(Vector const &v) {
+		pMin.x += v.x;  pMin.y += v.y;
+		pMax.x += v.x;  pMax.y += v.y;
+	}
+};
+
+
+
+} // namespace poly
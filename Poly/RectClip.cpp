@@ -0,0 +1,326 @@
+#include "RectClip.h"
+
+#include "Functions.h"
+
+#include <algorithm>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+namespace {
+
+
+
+/// Part of polygon boundary inside rectangle, from entry to exit point.
+//
+struct Chain
+{
+	unsigned begin, end;     ///< Range of points in RectClipper::points.
+	double entryT, exitT;    ///< Positions of first and last points on rectangle boundary.
+	bool used;
+};
+
+
+
+/// Clipping to rectangle, Weiler-Atherton style.
+/*!
+ * Position on rectangle boundary is given by number t in [0, 4), growing counterclockwise
+ * from corner pMin: integer part is the side (x = min, y = max, x = max, y = min), fractional
+ * part is the position on it.
+ */
+class RectClipper
+{
+public:
+	explicit RectClipper(Rect const &rect) : rect(rect) {}
+
+	void clip(Polygon const &polygon, vector<Polygon> &result);
+
+private:
+	Point vertex(unsigned i) const { return (*polygon)[ccw ? i : n - 1 - i]; }
+
+	bool outside(Point const &p) const {
+		return (p.x < rect.pMin.x) | (p.x > rect.pMax.x) | (p.y < rect.pMin.y) | (p.y > rect.pMax.y);
+	}
+
+	bool clipSegment(Point const &a, Point const &b, Point &p0, Point &p1, bool &entered, bool &exited) const;
+	double boundaryPos(Point const &p) const;
+	Point corner(unsigned side) const;
+
+	void traceChains();
+	void connectChains(vector<Polygon> &result);
+
+//Fields
+	Rect const rect;
+
+	Polygon const *polygon;
+	unsigned n;
+	bool ccw;
+
+	// Working memory, reused for all polygons
+	vector<Point> points;
+	vector<Chain> chains;
+	vector<unsigned> byEntry;   ///< Chain indices ordered by entry position.
+};
+
+
+
+/// Clip segment by Liang-Barsky algorithm.
+/*!
+ * Points of intersection with rectangle sides are put exactly on the sides.
+ *
+ * \param[out] p0, p1   Clipped segment, if not empty.
+ * \param[out] entered  Segment starts outside.
+ * \param[out] exited   Segment ends outside.
+ *
+ * \return False if segment does not intersect rectangle.
+ */
+bool RectClipper::clipSegment(Point const &a, Point const &b, Point &p0, Point &p1,
+                              bool &entered, bool &exited) const
+{
+	double const dx = b.x - a.x, dy = b.y - a.y;
+
+	// Parameters and sides of the latest entry and the earliest exit
+	double t0 = 0, t1 = 1;
+	int side0 = -1, side1 = -1;
+
+	// Sides: 0 - y = min, 1 - x = max, 2 - y = max, 3 - x = min
+	double const p[4] = { -dy, dx, dy, -dx };
+	double const q[4] = { a.y - rect.pMin.y, rect.pMax.x - a.x, rect.pMax.y - a.y, a.x - rect.pMin.x };
+
+	for ( int side = 0; side < 4; ++side ) {
+		if ( p[side] == 0 ) {
+			if ( q[side] < 0 )
+				return false;   // Parallel to side and outside
+			continue;
+		}
+
+		double const t = q[side] / p[side];
+		if ( p[side] < 0 ) {
+			if ( t > t0 ) { t0 = t;  side0 = side; }
+		}
+		else {
+			if ( t < t1 ) { t1 = t;  side1 = side; }
+		}
+	}
+
+	if ( t0 > t1 )
+		return false;
+
+	p0 = side0 < 0 ? a : Point(a.x + t0 * dx, a.y + t0 * dy);
+	p1 = side1 < 0 ? b : Point(a.x + t1 * dx, a.y + t1 * dy);
+
+	// Snap to sides
+	double const sideCoord[4] = { rect.pMin.y, rect.pMax.x, rect.pMax.y, rect.pMin.x };
+	if ( side0 >= 0 )
+		(side0 % 2 == 0 ? p0.y : p0.x) = sideCoord[side0];
+	if ( side1 >= 0 )
+		(side1 % 2 == 0 ? p1.y : p1.x) = sideCoord[side1];
+
+	entered = side0 >= 0;
+	exited = side1 >= 0;
+	return true;
+}
+
+
+
+/// Position of point on rectangle boundary.
+/*! \pre Point lies on the boundary.
+ */
+double RectClipper::boundaryPos(Point const &p) const
+{
+	double const w = rect.width(), h = rect.height();
+
+	if ( p.x == rect.pMin.x && p.y < rect.pMax.y )
+		return (p.y - rect.pMin.y) / h;
+	if ( p.y == rect.pMax.y && p.x < rect.pMax.x )
+		return 1 + (p.x - rect.pMin.x) / w;
+	if ( p.x == rect.pMax.x && p.y > rect.pMin.y )
+		return 2 + (rect.pMax.y - p.y) / h;
+	return 3 + (rect.pMax.x - p.x) / w;
+}
+
+
+
+/// Corner at the end of given side.
+//
+Point RectClipper::corner(unsigned side) const
+{
+	switch ( side % 4 ) {
+		case 0:  return Point(rect.pMin.x, rect.pMax.y);
+		case 1:  return rect.pMax;
+		case 2:  return Point(rect.pMax.x, rect.pMin.y);
+		default: return rect.pMin;
+	}
+}
+
+
+
+void RectClipper::clip(Polygon const &polygon, vector<Polygon> &result)
+{
+	if ( polygon.numVertices() < 3 )
+		return;
+
+	Rect const &bbox = polygon.boundingBox();
+	if ( ! bbox.intersects(rect) )
+		return;
+
+	this->polygon = &polygon;
+	n = polygon.numVertices();
+	ccw = polygon.isCcw();
+
+	if ( rect.contains(bbox) ) {
+		vector<Point> vertices(n);
+		for ( unsigned i = 0; i < n; ++i )
+			vertices[i] = vertex(i);
+		result.push_back(Polygon(move(vertices)));
+		return;
+	}
+
+	traceChains();
+
+	if ( chains.empty() ) {
+		// Boundaries do not cross, and polygon is not inside rectangle
+		if ( inside(Point((rect.pMin.x + rect.pMax.x) / 2, (rect.pMin.y + rect.pMax.y) / 2), polygon) ) {
+			vector<Point> vertices(4);
+			vertices[0] = rect.pMin;
+			for ( unsigned side = 0; side < 3; ++side )
+				vertices[side + 1] = corner(side);
+			result.push_back(Polygon(move(vertices)));
+		}
+		return;
+	}
+
+	connectChains(result);
+}
+
+
+
+/// Find parts of polygon boundary inside rectangle.
+/*!
+ * \pre Some vertex is outside rectangle.
+ */
+void RectClipper::traceChains()
+{
+	points.clear();
+	chains.clear();
+
+	unsigned start = 0;
+	while ( ! outside(vertex(start)) )
+		++start;
+
+	Point a = vertex(start);
+	for ( unsigned k = 1; k <= n; ++k ) {
+		Point const b = vertex((start + k) % n);
+
+		Point p0, p1;
+		bool entered, exited;
+		if ( clipSegment(a, b, p0, p1, entered, exited) ) {
+			if ( entered ) {
+				Chain const chain = { (unsigned)points.size(), 0, boundaryPos(p0), 0, false };
+				chains.push_back(chain);
+				points.push_back(p0);
+			}
+
+			if ( ! (points.back() == p1) )
+				points.push_back(p1);
+
+			if ( exited ) {
+				Chain &chain = chains.back();
+				chain.end = (unsigned)points.size();
+				chain.exitT = boundaryPos(p1);
+
+				// Polygon only touches the boundary
+				if ( chain.end - chain.begin < 2 ) {
+					points.resize(chain.begin);
+					chains.pop_back();
+				}
+			}
+		}
+
+		a = b;
+	}
+
+	byEntry.resize(chains.size());
+	for ( unsigned i = 0; i < chains.size(); ++i )
+		byEntry[i] = i;
+	sort(byEntry.begin(), byEntry.end(), [this](unsigned c1, unsigned c2)
+		{ return chains[c1].entryT < chains[c2].entryT; });
+}
+
+
+
+/// Connect chains into contours along rectangle boundary.
+/*!
+ * Interior of counterclockwise polygon is on the left, so after exit the contour goes
+ * counterclockwise along the rectangle to the next entry.
+ */
+void RectClipper::connectChains(vector<Polygon> &result)
+{
+	for ( Chain &startChain : chains ) {
+		if ( startChain.used )
+			continue;
+
+		vector<Point> vertices;
+
+		Chain *chain = &startChain;
+		do {
+			chain->used = true;
+			vertices.insert(vertices.end(), points.begin() + chain->begin, points.begin() + chain->end);
+
+			// Next entry counterclockwise from exit
+			double const exitT = chain->exitT;
+			auto it = upper_bound(byEntry.begin(), byEntry.end(), exitT, [this](double t, unsigned c)
+				{ return t < chains[c].entryT; });
+			if ( it == byEntry.end() )
+				it = byEntry.begin();
+			Chain *const next = &chains[*it];
+
+			// Corners passed on the way
+			unsigned side = (unsigned)exitT;
+			unsigned const entrySide = (unsigned)next->entryT + (next->entryT <= exitT ? 4 : 0);
+			for ( ; side < entrySide; ++side )
+				vertices.push_back(corner(side));
+
+			chain = next;
+		}
+		while ( ! chain->used );
+
+		if ( vertices.size() >= 3 )
+			result.push_back(Polygon(move(vertices)));
+	}
+}
+
+
+
+} // namespace
+
+
+
+vector<Polygon> clipToRect(Polygon const &polygon, Rect const &rect)
+{
+	vector<Polygon> rv;
+	RectClipper(rect).clip(polygon, rv);
+	return rv;
+}
+
+
+
+vector<vector<Polygon>> clipToRect(vector<Polygon const *> const &polygons, Rect const &rect)
+{
+	vector<vector<Polygon>> rv(polygons.size());
+
+	RectClipper clipper(rect);
+	for ( size_t i = 0; i < polygons.size(); ++i )
+		clipper.clip(*polygons[i], rv[i]);
+
+	return rv;
+}
+
+
+
+} // namespace poly
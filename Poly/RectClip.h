@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Polygon.h"
+#include "Rect.h"
+
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Clip polygon to axis-aligned rectangle.
+/*!
+ * O(n + k log k), where k is the number of crossings of polygon and rectangle boundaries.
+ * Parts of polygon inside rectangle are traced along polygon edges, and connected along
+ * rectangle boundary, so result can consist of several polygons.
+ *
+ * Unlike intersect(), polygon is not checked for simplicity and rectangle is not turned into
+ * general polygon. Parts of result degenerated to zero width along rectangle boundary are not
+ * removed.
+ *
+ * \pre Polygon is simple. Rectangle has non-zero width and height.
+ *
+ * \return Counterclockwise polygons.
+ */
+std::vector<Polygon> clipToRect(Polygon const &polygon, Rect const &rect);
+
+/// Clip many polygons to the same rectangle.
+/*!
+ * Working memory is shared by all polygons.
+ *
+ * \return Results of clipToRect() for each polygon, in the same order.
+ */
+std::vector<std::vector<Polygon>> clipToRect(std::vector<Polygon const *> const &polygons,
+                                             Rect const &rect);
+
+
+
+} // namespace poly
@@ -10,19 +10,23 @@ namespace poly {
 
 
 /// Segment ordered from p1 to p2.
-//
-class Segment
+/*! toLine() is available for double coordinates only.
+ */
+template <typename T>
+class BasicSegment
 {
 public:
-	Point p1, p2;
+	BasicPoint<T> p1, p2;
 
 //
-	Segment(Point const &p1, Point const &p2) : p1(p1), p2(p2) {}
+	BasicSegment(BasicPoint<T> const &p1, BasicPoint<T> const &p2) : p1(p1), p2(p2) {}
 
-	Vector toVector() const { return Vector(p1, p2); }
+	BasicVector<T> toVector() const { return BasicVector<T>(p1, p2); }
 	Line toLine() const { return Line(p1, p2); }
 };
 
+typedef BasicSegment<double> Segment;
+
 
 
 } // namespace poly
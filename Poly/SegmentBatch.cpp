@@ -0,0 +1,267 @@
+#include "SegmentBatch.h"
+
+#include "Functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define POLY_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define POLY_TARGET_AVX2
+	#else
+		#define POLY_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+namespace {
+
+
+
+/// Block of segments, as pointers to their coordinates.
+//
+struct Block
+{
+	double const *x1, *y1, *x2, *y2;
+};
+
+
+
+/// Test segment against block of segments.
+/*!
+ * \param[out] hits       Bit mask of segments surely intersecting.
+ * \param[out] undecided  Bit mask of segments needing exact test.
+ */
+typedef void (*BlockKernel)(Segment const &s, Block const &block, unsigned &hits, unsigned &undecided);
+
+
+
+double const ErrorBound = predicates::detail::CrossErrorBound;
+
+
+
+void blockKernel_Portable(Segment const &s, Block const &block, unsigned &hits, unsigned &undecided)
+{
+	double const sxMin = min(s.p1.x, s.p2.x), sxMax = max(s.p1.x, s.p2.x);
+	double const syMin = min(s.p1.y, s.p2.y), syMax = max(s.p1.y, s.p2.y);
+	double const ux = s.p2.x - s.p1.x, uy = s.p2.y - s.p1.y;
+
+	hits = undecided = 0;
+
+	for ( unsigned i = 0; i < SegmentBatch::BlockSize; ++i ) {
+		double const bx1 = block.x1[i], by1 = block.y1[i], bx2 = block.x2[i], by2 = block.y2[i];
+
+		bool const boxes = sxMin <= max(bx1, bx2) && min(bx1, bx2) <= sxMax &&
+		                   syMin <= max(by1, by2) && min(by1, by2) <= syMax;
+
+		// Orientations of ends of each segment relative to the other, as in crossSign()
+		double const vx = bx2 - bx1, vy = by2 - by1;
+		double const l1 = ux * (by1 - s.p1.y), r1 = uy * (bx1 - s.p1.x);
+		double const l2 = ux * (by2 - s.p1.y), r2 = uy * (bx2 - s.p1.x);
+		double const l3 = vx * (s.p1.y - by1), r3 = vy * (s.p1.x - bx1);
+		double const l4 = vx * (s.p2.y - by1), r4 = vy * (s.p2.x - bx1);
+		double const d1 = l1 - r1, e1 = ErrorBound * (fabs(l1) + fabs(r1));
+		double const d2 = l2 - r2, e2 = ErrorBound * (fabs(l2) + fabs(r2));
+		double const d3 = l3 - r3, e3 = ErrorBound * (fabs(l3) + fabs(r3));
+		double const d4 = l4 - r4, e4 = ErrorBound * (fabs(l4) + fabs(r4));
+
+		bool const pos1 = d1 > e1, neg1 = -d1 > e1, pos2 = d2 > e2, neg2 = -d2 > e2;
+		bool const pos3 = d3 > e3, neg3 = -d3 > e3, pos4 = d4 > e4, neg4 = -d4 > e4;
+
+		bool const reject = (! boxes) | (pos1 & pos2) | (neg1 & neg2) | (pos3 & pos4) | (neg3 & neg4);
+		bool const accept = ((pos1 & neg2) | (neg1 & pos2)) & ((pos3 & neg4) | (neg3 & pos4));
+
+		hits |= unsigned(! reject & accept) << i;
+		undecided |= unsigned(! reject & ! accept) << i;
+	}
+}
+
+
+
+#ifdef POLY_X86
+
+/// Masks of certainly positive and certainly negative determinants l - r.
+//
+POLY_TARGET_AVX2
+inline void orientSigns_AVX2(__m256d l, __m256d r, __m256d &pos, __m256d &neg)
+{
+	__m256d const signMask = _mm256_set1_pd(-0.0);
+
+	__m256d const d = _mm256_sub_pd(l, r);
+	__m256d const sum = _mm256_add_pd(_mm256_andnot_pd(signMask, l), _mm256_andnot_pd(signMask, r));
+	__m256d const errBound = _mm256_mul_pd(_mm256_set1_pd(ErrorBound), sum);
+	pos = _mm256_cmp_pd(d, errBound, _CMP_GT_OQ);
+	neg = _mm256_cmp_pd(_mm256_xor_pd(d, signMask), errBound, _CMP_GT_OQ);
+}
+
+
+
+POLY_TARGET_AVX2
+void blockKernel_AVX2(Segment const &s, Block const &block, unsigned &hits, unsigned &undecided)
+{
+	__m256d const bx1 = _mm256_loadu_pd(block.x1), by1 = _mm256_loadu_pd(block.y1);
+	__m256d const bx2 = _mm256_loadu_pd(block.x2), by2 = _mm256_loadu_pd(block.y2);
+
+	// Boxes
+	__m256d const bxMin = _mm256_min_pd(bx1, bx2), bxMax = _mm256_max_pd(bx1, bx2);
+	__m256d const byMin = _mm256_min_pd(by1, by2), byMax = _mm256_max_pd(by1, by2);
+	__m256d const sxMin = _mm256_set1_pd(min(s.p1.x, s.p2.x)), sxMax = _mm256_set1_pd(max(s.p1.x, s.p2.x));
+	__m256d const syMin = _mm256_set1_pd(min(s.p1.y, s.p2.y)), syMax = _mm256_set1_pd(max(s.p1.y, s.p2.y));
+
+	__m256d const boxes = _mm256_and_pd(
+		_mm256_and_pd(_mm256_cmp_pd(sxMin, bxMax, _CMP_LE_OQ), _mm256_cmp_pd(bxMin, sxMax, _CMP_LE_OQ)),
+		_mm256_and_pd(_mm256_cmp_pd(syMin, byMax, _CMP_LE_OQ), _mm256_cmp_pd(byMin, syMax, _CMP_LE_OQ)));
+
+	// Orientations
+	__m256d const ax1 = _mm256_set1_pd(s.p1.x), ay1 = _mm256_set1_pd(s.p1.y);
+	__m256d const ax2 = _mm256_set1_pd(s.p2.x), ay2 = _mm256_set1_pd(s.p2.y);
+	__m256d const ux = _mm256_set1_pd(s.p2.x - s.p1.x), uy = _mm256_set1_pd(s.p2.y - s.p1.y);
+	__m256d const vx = _mm256_sub_pd(bx2, bx1), vy = _mm256_sub_pd(by2, by1);
+
+	__m256d pos[4], neg[4];
+	orientSigns_AVX2(_mm256_mul_pd(ux, _mm256_sub_pd(by1, ay1)), _mm256_mul_pd(uy, _mm256_sub_pd(bx1, ax1)), pos[0], neg[0]);
+	orientSigns_AVX2(_mm256_mul_pd(ux, _mm256_sub_pd(by2, ay1)), _mm256_mul_pd(uy, _mm256_sub_pd(bx2, ax1)), pos[1], neg[1]);
+	orientSigns_AVX2(_mm256_mul_pd(vx, _mm256_sub_pd(ay1, by1)), _mm256_mul_pd(vy, _mm256_sub_pd(ax1, bx1)), pos[2], neg[2]);
+	orientSigns_AVX2(_mm256_mul_pd(vx, _mm256_sub_pd(ay2, by1)), _mm256_mul_pd(vy, _mm256_sub_pd(ax2, bx1)), pos[3], neg[3]);
+
+	__m256d const sameSide = _mm256_or_pd(
+		_mm256_or_pd(_mm256_and_pd(pos[0], pos[1]), _mm256_and_pd(neg[0], neg[1])),
+		_mm256_or_pd(_mm256_and_pd(pos[2], pos[3]), _mm256_and_pd(neg[2], neg[3])));
+	__m256d const crossing = _mm256_and_pd(
+		_mm256_or_pd(_mm256_and_pd(pos[0], neg[1]), _mm256_and_pd(neg[0], pos[1])),
+		_mm256_or_pd(_mm256_and_pd(pos[2], neg[3]), _mm256_and_pd(neg[2], pos[3])));
+
+	unsigned const reject = (unsigned)_mm256_movemask_pd(_mm256_andnot_pd(boxes, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))))
+	                      | (unsigned)_mm256_movemask_pd(sameSide);
+	unsigned const accept = (unsigned)_mm256_movemask_pd(crossing);
+
+	hits = ~reject & accept & 0xF;
+	undecided = ~reject & ~accept & 0xF;
+}
+
+
+
+bool cpuSupportsAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if ( info[0] < 7 )
+		return false;
+
+	__cpuid(info, 1);
+	bool const osxsave = (info[2] & (1 << 27)) != 0;
+	bool const avx = (info[2] & (1 << 28)) != 0;
+	if ( ! osxsave || ! avx || (_xgetbv(0) & 6) != 6 )
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // POLY_X86
+
+
+
+BlockKernel chooseKernel()
+{
+#ifdef POLY_X86
+	if ( cpuSupportsAVX2() )
+		return blockKernel_AVX2;
+#endif
+	return blockKernel_Portable;
+}
+
+BlockKernel const blockKernel = chooseKernel();
+
+
+
+} // namespace
+
+
+
+void SegmentBatch::clear()
+{
+	x1.clear();  y1.clear();  x2.clear();  y2.clear();
+	count = 0;
+}
+
+
+
+void SegmentBatch::reserve(unsigned n)
+{
+	unsigned const padded = (n + BlockSize - 1) / BlockSize * BlockSize;
+	x1.reserve(padded);  y1.reserve(padded);  x2.reserve(padded);  y2.reserve(padded);
+}
+
+
+
+void SegmentBatch::add(Segment const &s)
+{
+	// Padding is NaN, it never passes box test
+	if ( count % BlockSize == 0 ) {
+		double const nan = numeric_limits<double>::quiet_NaN();
+		x1.resize(count + BlockSize, nan);  y1.resize(count + BlockSize, nan);
+		x2.resize(count + BlockSize, nan);  y2.resize(count + BlockSize, nan);
+	}
+
+	x1[count] = s.p1.x;  y1[count] = s.p1.y;
+	x2[count] = s.p2.x;  y2[count] = s.p2.y;
+	++count;
+}
+
+
+
+unsigned SegmentBatch::findIntersecting(Segment const &s, unsigned begin, unsigned end) const
+{
+	for ( unsigned blockBegin = begin / BlockSize * BlockSize; blockBegin < end; blockBegin += BlockSize ) {
+		Block const block = { &x1[blockBegin], &y1[blockBegin], &x2[blockBegin], &y2[blockBegin] };
+
+		unsigned hits, undecided;
+		blockKernel(s, block, hits, undecided);
+
+		// Lanes outside of range
+		unsigned mask = 0xF;
+		if ( blockBegin < begin )
+			mask &= 0xF << (begin - blockBegin);
+		if ( end - blockBegin < BlockSize )
+			mask &= (1u << (end - blockBegin)) - 1;
+
+		hits &= mask;
+		undecided &= mask;
+
+		for ( unsigned i = 0; (hits | undecided) >> i; ++i ) {
+			if ( (hits >> i) & 1 )
+				return blockBegin + i;
+			if ( ((undecided >> i) & 1) && intersects(s, segment(blockBegin + i)) )
+				return blockBegin + i;
+		}
+	}
+
+	return end;
+}
+
+
+
+char const * SegmentBatch::kernelName()
+{
+	return blockKernel == blockKernel_Portable ? "portable" : "AVX2";
+}
+
+
+
+} // namespace poly
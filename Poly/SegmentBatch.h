@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Segment.h"
+
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/// Segments packed by coordinates, for testing one segment against many at once.
+/*!
+ * Segments are tested in blocks of BlockSize by a SIMD kernel chosen at runtime (AVX2 if
+ * the processor supports it, portable code otherwise). The kernel rejects by bounding boxes and
+ * decides by orientations evaluated in floating point; segments for which any orientation is
+ * within its error bound are retested by intersects(Segment, Segment). So answers are exactly
+ * the same as of intersects(Segment, Segment).
+ */
+class SegmentBatch
+{
+public:
+	enum { BlockSize = 4 };
+
+	SegmentBatch() : count(0) {}
+
+	unsigned size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	void clear();
+	void reserve(unsigned n);
+	void add(Segment const &s);
+
+	Segment segment(unsigned i) const { return Segment(Point(x1[i], y1[i]), Point(x2[i], y2[i])); }
+
+	/// Find first segment in range [begin, end) intersecting or touching given one.
+	/*! \return Index of segment, or end if there is none.
+	 */
+	unsigned findIntersecting(Segment const &s, unsigned begin, unsigned end) const;
+
+	/// The same in whole batch.
+	unsigned findIntersecting(Segment const &s, unsigned begin = 0) const
+		{ return findIntersecting(s, begin, count); }
+
+	/// Name of the kernel used, for benchmarks.
+	static char const * kernelName();
+
+private:
+	// Coordinates of endpoints, padded to whole blocks
+	std::vector<double> x1, y1, x2, y2;
+	unsigned count;
+};
+
+
+
+} // namespace poly
@@ -0,0 +1,846 @@
+#include "SnapBoolean.h"
+
+#include "Kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+
+namespace poly {
+
+using namespace std;
+
+
+
+namespace {
+
+typedef BasicPoint<int64_t> GridPoint;
+
+
+
+/// Sign of cross product (b - a) x (c - a): positive if c is to the left of a->b, with Y axis up.
+//
+inline int orientSign(GridPoint const &a, GridPoint const &b, GridPoint const &c)
+{
+	return CoordTraits<int64_t>::crossSign(a, b, a, c);
+}
+
+
+
+/// Signed 128-bit integer, two's complement.
+//
+struct Wide
+{
+	uint64_t lo, hi;
+
+	Wide() : lo(0), hi(0) {}
+	explicit Wide(int64_t v) : lo(uint64_t(v)), hi(v < 0 ? ~uint64_t(0) : 0) {}
+
+	Wide operator+(Wide const &r) const {
+		Wide w;
+		w.lo = lo + r.lo;
+		w.hi = hi + r.hi + (w.lo < lo ? 1 : 0);
+		return w;
+	}
+
+	Wide operator-() const {
+		Wide w;
+		w.lo = ~lo + 1;
+		w.hi = ~hi + (w.lo == 0 ? 1 : 0);
+		return w;
+	}
+
+	Wide operator-(Wide const &r) const { return *this + -r; }
+
+	int sign() const { return int64_t(hi) < 0 ? -1 : (hi != 0 || lo != 0 ? 1 : 0); }
+
+	double toDouble() const {
+		if ( sign() < 0 )
+			return -(-*this).toDouble();
+		return ldexp(double(hi), 64) + double(lo);
+	}
+
+	static Wide product(int64_t a, int64_t b) {
+		Wide w;
+		predicates::detail::multiplyWide(a < 0 ? 0 - uint64_t(a) : uint64_t(a),
+		                                 b < 0 ? 0 - uint64_t(b) : uint64_t(b), w.hi, w.lo);
+		return (a < 0) != (b < 0) ? -w : w;
+	}
+};
+
+
+
+/// floor(n / d).
+/*! \pre d > 0, result fits in 53 bits.
+ */
+int64_t floorDiv(Wide const &n, int64_t d)
+{
+	// Estimate in floating point, then correct exactly
+	int64_t q = (int64_t)floor(n.toDouble() / double(d));
+	while ( (Wide::product(q, d) - n).sign() > 0 )
+		--q;
+	while ( (n - Wide::product(q + 1, d)).sign() >= 0 )
+		++q;
+	return q;
+}
+
+
+
+/// Grid point nearest to the crossing point of segments, halves rounded up.
+/*! \pre Segments cross properly.
+ */
+GridPoint roundCrossing(GridPoint const &a, GridPoint const &b, GridPoint const &c, GridPoint const &d)
+{
+	// Crossing point is a + (b - a) * num / den. With coordinates within MaxSnapCoordinate,
+	// num and den fit in 62 bits.
+	int64_t const d1x = b.x - a.x, d1y = b.y - a.y;
+	int64_t const d2x = d.x - c.x, d2y = d.y - c.y;
+
+	int64_t den = d1x * d2y - d1y * d2x;
+	int64_t num = (c.x - a.x) * d2y - (c.y - a.y) * d2x;
+	if ( den < 0 ) {
+		den = -den;
+		num = -num;
+	}
+
+	// floor(a + d1 * num / den + 1/2)
+	return GridPoint(a.x + floorDiv(Wide::product(2 * d1x, num) + Wide(den), 2 * den),
+	                 a.y + floorDiv(Wide::product(2 * d1y, num) + Wide(den), 2 * den));
+}
+
+
+
+/// Test if segment a-b intersects pixel around grid point h.
+/*!
+ * Pixel is the half-open square [h - 1/2, h + 1/2), so that each point belongs to one pixel, as
+ * with rounding by roundCrossing(). Then pixels passed by a segment follow each other along it.
+ *
+ * \pre h is in bounding box of segment.
+ */
+bool passesPixel(GridPoint const &a, GridPoint const &b, GridPoint const &h)
+{
+	// In doubled coordinates, pixel is [2h - 1, 2h + 1); its open sides are moved in by
+	// infinitesimal eps
+	GridPoint const a2(2 * a.x, 2 * a.y), b2(2 * b.x, 2 * b.y);
+	int64_t const dx = b2.x - a2.x, dy = b2.y - a2.y;
+
+	if ( ! (min(a2.x, b2.x) < 2 * h.x + 1 && min(a2.y, b2.y) < 2 * h.y + 1) )
+		return false;
+
+	bool left = false, right = false;
+	for ( int cx = -1; cx <= 1; cx += 2 )
+		for ( int cy = -1; cy <= 1; cy += 2 ) {
+			int s = orientSign(a2, b2, GridPoint(2 * h.x + cx, 2 * h.y + cy));
+			if ( s == 0 ) {
+				// Side of corner moved by (-eps, 0) on the right side, (0, -eps) on the top
+				int64_t const t = (cx > 0 ? dy : 0) - (cy > 0 ? dx : 0);
+				s = t > 0 ? 1 : (t < 0 ? -1 : 0);
+			}
+			if ( s == 0 )
+				return true;
+			(s > 0 ? left : right) = true;
+		}
+
+	return left && right;
+}
+
+
+
+/// Angular order of directions counterclockwise from X axis, with Y axis up.
+//
+bool angleLess(GridPoint const &d1, GridPoint const &d2)
+{
+	bool const upper1 = d1.y > 0 || (d1.y == 0 && d1.x > 0);
+	bool const upper2 = d2.y > 0 || (d2.y == 0 && d2.x > 0);
+	if ( upper1 != upper2 )
+		return upper1;
+	return predicates::productDiffSign(d1.x, d2.y, d1.y, d2.x) > 0;
+}
+
+
+
+/// Set of hot pixels, given by grid points in their centers.
+//
+class HotPixels
+{
+public:
+	void add(GridPoint const &p) { pixels.push_back(p); }
+
+	void finish() {
+		sort(pixels.begin(), pixels.end());
+		pixels.erase(unique(pixels.begin(), pixels.end()), pixels.end());
+	}
+
+	/// Visit pixels with centers in bounding box of two points.
+	template <typename Visitor>
+	void query(GridPoint const &p1, GridPoint const &p2, Visitor visit) const;
+
+private:
+	vector<GridPoint> pixels;   ///< Sorted lexicographically.
+};
+
+
+
+template <typename Visitor>
+void HotPixels::query(GridPoint const &p1, GridPoint const &p2, Visitor visit) const
+{
+	int64_t const xMax = max(p1.x, p2.x);
+	int64_t const yMin = min(p1.y, p2.y), yMax = max(p1.y, p2.y);
+
+	// Pixels of each column are contiguous; skip to the Y range in each
+	auto it = lower_bound(pixels.begin(), pixels.end(), GridPoint(min(p1.x, p2.x), yMin));
+	while ( it != pixels.end() && it->x <= xMax ) {
+		if ( it->y < yMin )
+			it = lower_bound(it, pixels.end(), GridPoint(it->x, yMin));
+		else if ( it->y > yMax )
+			it = lower_bound(it, pixels.end(), GridPoint(it->x + 1, yMin));
+		else
+			visit(*it++);
+	}
+}
+
+
+
+/// Arrangement of snap rounded contours, with winding numbers of faces.
+/*!
+ * Contours are added to channels, and winding numbers are counted for each channel separately.
+ * Edges of arrangement are merged fragments of contours; a fragment adds +1 to winding number on
+ * its left side, with Y axis up.
+ */
+class SnapOverlay
+{
+public:
+	enum { MaxChannels = 2 };
+
+	SnapOverlay(unsigned channels, double gridStep) : channels(channels), gridStep(gridStep) {}
+
+	void addContour(Polygon const &polygon, unsigned channel, bool reverse);
+
+	void build();
+
+	/// Trace contours of region.
+	/*!
+	 * \param inside      Functor bool(int const *windings), windings for all channels.
+	 * \param allowHoles  Return holes as clockwise contours instead of throwing.
+	 */
+	template <typename Inside>
+	vector<Polygon> extract(Inside inside, bool allowHoles = false) const;
+
+private:
+	struct InputSegment {
+		GridPoint a, b;
+		unsigned channel;
+	};
+
+	struct Fragment {
+		GridPoint p, q;   ///< Lexicographically ordered.
+		unsigned channel;
+		int dir;          ///< +1 if contour goes from p to q, -1 otherwise.
+	};
+
+	struct Edge {
+		GridPoint p, q;   ///< Lexicographically ordered.
+		int delta[MaxChannels];   ///< Winding number on the left of p->q minus on the right.
+	};
+
+	void findCrossings();
+	void route(InputSegment const &s, vector<Fragment> &fragments) const;
+	void split(GridPoint const &p, GridPoint const &q, unsigned channel, int dir,
+	           vector<Fragment> &fragments) const;
+	void mergeFragments(vector<Fragment> &fragments);
+	void buildGraph();
+	void traceFaces();
+	void computeWindings();
+	void rayWindings(vector<unsigned> const &nodes, vector<int> &windings) const;
+	void addRing(unsigned const *ring, size_t size, bool allowHoles, vector<Polygon> &rv) const;
+
+	unsigned node(GridPoint const &p) const
+		{ return unsigned(lower_bound(nodes.begin(), nodes.end(), p) - nodes.begin()); }
+
+	unsigned origin(unsigned h) const { return h & 1 ? edgeNodes[h/2].second : edgeNodes[h/2].first; }
+	unsigned target(unsigned h) const { return origin(h ^ 1); }
+	unsigned next(unsigned h) const;
+
+	GridPoint direction(unsigned h) const {
+		GridPoint const &p1 = nodes[origin(h)], &p2 = nodes[target(h)];
+		return GridPoint(p2.x - p1.x, p2.y - p1.y);
+	}
+
+	/// Winding difference from the right to the left side of half-edge.
+	int delta(unsigned h, unsigned channel) const
+		{ return h & 1 ? -edges[h/2].delta[channel] : edges[h/2].delta[channel]; }
+
+//Fields
+	unsigned channels;
+	double gridStep;
+
+	vector<InputSegment> segments;
+	HotPixels hotPixels;
+
+	vector<Edge> edges;
+	vector<GridPoint> nodes;                         ///< Sorted lexicographically.
+	vector<pair<unsigned, unsigned>> edgeNodes;      ///< Nodes of edges.
+	vector<unsigned> outStart;                       ///< Node -> first of its out half-edges.
+	vector<unsigned> outEdges;                       ///< Out half-edges of nodes, counterclockwise.
+	vector<unsigned> outPos;                         ///< Half-edge -> position in outEdges.
+	vector<unsigned> faceOf;                         ///< Half-edge -> face on the left.
+	vector<unsigned> faceEdge;                       ///< Face -> one of its half-edges.
+	vector<int> windings;                            ///< Face * channels + channel -> winding number.
+};
+
+
+
+void SnapOverlay::addContour(Polygon const &polygon, unsigned channel, bool reverse)
+{
+	vector<GridPoint> points;
+	points.reserve(polygon.numVertices());
+
+	for ( Point const &v : polygon ) {
+		double const x = floor(v.x / gridStep + 0.5), y = floor(v.y / gridStep + 0.5);
+		if ( ! (fabs(x) <= MaxSnapCoordinate && fabs(y) <= MaxSnapCoordinate) )
+			throw range_error("Grid coordinates out of range");
+
+		GridPoint const p((int64_t)x, (int64_t)y);
+		if ( points.empty() || ! (points.back() == p) )
+			points.push_back(p);
+	}
+	while ( points.size() > 1 && points.back() == points.front() )
+		points.pop_back();
+
+	if ( points.size() < 2 )
+		return;
+	if ( reverse )
+		std::reverse(points.begin(), points.end());
+
+	for ( size_t i = 0; i < points.size(); ++i ) {
+		hotPixels.add(points[i]);
+		InputSegment const s = { points[i], points[i + 1 < points.size() ? i + 1 : 0], channel };
+		segments.push_back(s);
+	}
+}
+
+
+
+void SnapOverlay::build()
+{
+	findCrossings();
+	hotPixels.finish();
+
+	vector<Fragment> fragments;
+	fragments.reserve(segments.size() * 2);
+	for ( InputSegment const &s : segments )
+		route(s, fragments);
+
+	mergeFragments(fragments);
+	buildGraph();
+	traceFaces();
+	computeWindings();
+}
+
+
+
+/// Add rounded crossings of segments to hot pixels.
+/*!
+ * O(n log n + P), where P is the number of pairs of segments overlapping in X, up to O(n^2) for
+ * many long segments.
+ */
+void SnapOverlay::findCrossings()
+{
+	vector<unsigned> order(segments.size());
+	for ( unsigned i = 0; i < order.size(); ++i )
+		order[i] = i;
+
+	auto minX = [this](unsigned i) { return min(segments[i].a.x, segments[i].b.x); };
+	sort(order.begin(), order.end(), [&](unsigned i, unsigned j) { return minX(i) < minX(j); });
+
+	// Only segments overlapping in X are tested
+	for ( size_t i = 0; i < order.size(); ++i ) {
+		InputSegment const &s1 = segments[order[i]];
+		int64_t const xMax = max(s1.a.x, s1.b.x);
+		int64_t const yMin = min(s1.a.y, s1.b.y), yMax = max(s1.a.y, s1.b.y);
+
+		for ( size_t j = i + 1; j < order.size() && minX(order[j]) <= xMax; ++j ) {
+			InputSegment const &s2 = segments[order[j]];
+			if ( max(s2.a.y, s2.b.y) < yMin || min(s2.a.y, s2.b.y) > yMax )
+				continue;
+
+			int const o1 = orientSign(s1.a, s1.b, s2.a), o2 = orientSign(s1.a, s1.b, s2.b);
+			if ( o1 * o2 >= 0 )
+				continue;
+			int const o3 = orientSign(s2.a, s2.b, s1.a), o4 = orientSign(s2.a, s2.b, s1.b);
+			if ( o3 * o4 >= 0 )
+				continue;
+
+			hotPixels.add(roundCrossing(s1.a, s1.b, s2.a, s2.b));
+		}
+	}
+}
+
+
+
+/// Route segment through hot pixels it passes, and add resulting fragments.
+//
+void SnapOverlay::route(InputSegment const &s, vector<Fragment> &fragments) const
+{
+	vector<GridPoint> chain;
+	hotPixels.query(s.a, s.b, [&](GridPoint const &h) {
+		if ( ! (h == s.a) && ! (h == s.b) && passesPixel(s.a, s.b, h) )
+			chain.push_back(h);
+	});
+
+	// Order by projection onto segment
+	int64_t const dx = s.b.x - s.a.x, dy = s.b.y - s.a.y;
+	sort(chain.begin(), chain.end(), [dx, dy](GridPoint const &h1, GridPoint const &h2) {
+		int const s = predicates::productDiffSign(h1.x - h2.x, dx, h2.y - h1.y, dy);
+		return s < 0 || (s == 0 && h1 < h2);
+	});
+
+	GridPoint prev = s.a;
+	chain.push_back(s.b);
+	for ( GridPoint const &p : chain ) {
+		if ( p == prev )
+			continue;
+		bool const forward = prev < p;
+		split(forward ? prev : p, forward ? p : prev, s.channel, forward ? 1 : -1, fragments);
+		prev = p;
+	}
+}
+
+
+
+/// Add fragment, split at hot pixel centers lying exactly on it.
+/*!
+ * Rounded fragments can pass through centers of hot pixels that the original segment did not
+ * touch. Splitting there keeps arrangement planar: fragments meet only at endpoints.
+ */
+void SnapOverlay::split(GridPoint const &p, GridPoint const &q, unsigned channel, int dir,
+                        vector<Fragment> &fragments) const
+{
+	vector<GridPoint> inner;
+	hotPixels.query(p, q, [&](GridPoint const &h) {
+		if ( ! (h == p) && ! (h == q) && orientSign(p, q, h) == 0 )
+			inner.push_back(h);
+	});
+
+	// Collinear points on fragment are ordered lexicographically, as p and q
+	sort(inner.begin(), inner.end());
+
+	GridPoint prev = p;
+	inner.push_back(q);
+	for ( GridPoint const &h : inner ) {
+		Fragment const f = { prev, h, channel, dir };
+		fragments.push_back(f);
+		prev = h;
+	}
+}
+
+
+
+/// Merge coincident fragments into edges, summing their windings.
+//
+void SnapOverlay::mergeFragments(vector<Fragment> &fragments)
+{
+	sort(fragments.begin(), fragments.end(), [](Fragment const &f1, Fragment const &f2) {
+		return f1.p < f2.p || (f1.p == f2.p && f1.q < f2.q);
+	});
+
+	for ( size_t i = 0; i < fragments.size(); ) {
+		Edge e = { fragments[i].p, fragments[i].q, { 0, 0 } };
+		for ( ; i < fragments.size() && fragments[i].p == e.p && fragments[i].q == e.q; ++i )
+			e.delta[fragments[i].channel] += fragments[i].dir;
+
+		bool nonZero = false;
+		for ( unsigned c = 0; c < channels; ++c )
+			nonZero = nonZero || e.delta[c] != 0;
+		if ( nonZero )
+			edges.push_back(e);
+	}
+}
+
+
+
+/// Index nodes and sort their out half-edges counterclockwise.
+/*!
+ * Half-edge 2*e goes along edge e from p to q, half-edge 2*e + 1 goes back.
+ */
+void SnapOverlay::buildGraph()
+{
+	for ( Edge const &e : edges ) {
+		nodes.push_back(e.p);
+		nodes.push_back(e.q);
+	}
+	sort(nodes.begin(), nodes.end());
+	nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+
+	edgeNodes.reserve(edges.size());
+	for ( Edge const &e : edges )
+		edgeNodes.push_back(make_pair(node(e.p), node(e.q)));
+
+	// Out half-edges by counting sort of origins, then by angle
+	unsigned const numHalfEdges = unsigned(edges.size() * 2);
+	outStart.assign(nodes.size() + 1, 0);
+	for ( unsigned h = 0; h < numHalfEdges; ++h )
+		++outStart[origin(h) + 1];
+	for ( size_t i = 1; i < outStart.size(); ++i )
+		outStart[i] += outStart[i - 1];
+
+	outEdges.resize(numHalfEdges);
+	vector<unsigned> fill(outStart.begin(), outStart.end() - 1);
+	for ( unsigned h = 0; h < numHalfEdges; ++h )
+		outEdges[fill[origin(h)]++] = h;
+
+	outPos.resize(numHalfEdges);
+	for ( unsigned n = 0; n < nodes.size(); ++n ) {
+		auto const begin = outEdges.begin() + outStart[n], end = outEdges.begin() + outStart[n + 1];
+		sort(begin, end, [this](unsigned h1, unsigned h2) {
+			return angleLess(direction(h1), direction(h2));
+		});
+		for ( unsigned i = outStart[n]; i < outStart[n + 1]; ++i )
+			outPos[outEdges[i]] = i;
+	}
+}
+
+
+
+/// Next half-edge of the face on the left: the first one clockwise from the twin.
+//
+unsigned SnapOverlay::next(unsigned h) const
+{
+	unsigned const twin = h ^ 1;
+	unsigned const n = origin(twin);
+	unsigned const pos = outPos[twin];
+	return outEdges[pos > outStart[n] ? pos - 1 : outStart[n + 1] - 1];
+}
+
+
+
+void SnapOverlay::traceFaces()
+{
+	unsigned const noFace = ~0u;
+	faceOf.assign(edges.size() * 2, noFace);
+
+	for ( unsigned h0 = 0; h0 < faceOf.size(); ++h0 ) {
+		if ( faceOf[h0] != noFace )
+			continue;
+
+		unsigned const face = unsigned(faceEdge.size());
+		faceEdge.push_back(h0);
+		for ( unsigned h = h0; faceOf[h] == noFace; h = next(h) )
+			faceOf[h] = face;
+	}
+}
+
+
+
+/// Compute winding numbers of faces.
+/*!
+ * Outer face of each connected component gets winding numbers by ray casting from its
+ * lexicographically lowest node, and the other faces of the component by crossing edges.
+ */
+void SnapOverlay::computeWindings()
+{
+	unsigned const noComponent = ~0u;
+	vector<unsigned> component(nodes.size(), noComponent);
+	vector<unsigned> lowest;   // Of each component
+	vector<unsigned> outerFaces;
+
+	// Nodes are sorted, so the first node found of a component is the lowest
+	vector<unsigned> stack;
+	for ( unsigned n0 = 0; n0 < nodes.size(); ++n0 ) {
+		if ( component[n0] != noComponent )
+			continue;
+
+		unsigned const c = unsigned(lowest.size());
+		lowest.push_back(n0);
+		component[n0] = c;
+		stack.push_back(n0);
+		while ( ! stack.empty() ) {
+			unsigned const n = stack.back();
+			stack.pop_back();
+			for ( unsigned i = outStart[n]; i < outStart[n + 1]; ++i ) {
+				unsigned const m = target(outEdges[i]);
+				if ( component[m] == noComponent ) {
+					component[m] = c;
+					stack.push_back(m);
+				}
+			}
+		}
+
+		// All neighbours are to the right or straight up, so the outer face is on the left of
+		// the out half-edge turned most counterclockwise from straight down
+		unsigned outer = outEdges[outStart[n0]];
+		for ( unsigned i = outStart[n0] + 1; i < outStart[n0 + 1]; ++i ) {
+			GridPoint const d = direction(outEdges[i]), dOuter = direction(outer);
+			if ( predicates::productDiffSign(dOuter.x, d.y, dOuter.y, d.x) > 0 )
+				outer = outEdges[i];
+		}
+		outerFaces.push_back(faceOf[outer]);
+	}
+
+	vector<int> outerWindings;
+	rayWindings(lowest, outerWindings);
+
+	// Spread windings over faces of each component
+	vector<bool> known(faceEdge.size(), false);
+	windings.assign(faceEdge.size() * channels, 0);
+
+	vector<unsigned> queue;
+	for ( unsigned c = 0; c < outerFaces.size(); ++c ) {
+		unsigned const f0 = outerFaces[c];
+		known[f0] = true;
+		copy(outerWindings.begin() + c * channels, outerWindings.begin() + (c + 1) * channels,
+		     windings.begin() + f0 * channels);
+		queue.push_back(f0);
+
+		while ( ! queue.empty() ) {
+			unsigned const f = queue.back();
+			queue.pop_back();
+
+			unsigned h = faceEdge[f];
+			do {
+				unsigned const g = faceOf[h ^ 1];
+				if ( ! known[g] ) {
+					known[g] = true;
+					for ( unsigned ch = 0; ch < channels; ++ch )
+						windings[g * channels + ch] = windings[f * channels + ch] - delta(h, ch);
+					queue.push_back(g);
+				}
+				h = next(h);
+			} while ( h != faceEdge[f] );
+		}
+	}
+}
+
+
+
+/// Winding numbers of points just below given nodes.
+/*!
+ * Counts edges crossing the ray from point to the right, sweeping nodes upwards.
+ *
+ * \param[out] windings  Node index in list * channels + channel -> winding number.
+ */
+void SnapOverlay::rayWindings(vector<unsigned> const &queryNodes, vector<int> &windings) const
+{
+	windings.assign(queryNodes.size() * channels, 0);
+
+	vector<unsigned> queries(queryNodes.size());
+	for ( unsigned i = 0; i < queries.size(); ++i )
+		queries[i] = i;
+	sort(queries.begin(), queries.end(), [&](unsigned i, unsigned j) {
+		return nodes[queryNodes[i]].y < nodes[queryNodes[j]].y;
+	});
+
+	vector<unsigned> byMinY(edges.size());
+	for ( unsigned i = 0; i < byMinY.size(); ++i )
+		byMinY[i] = i;
+	auto minY = [this](unsigned e) { return min(edges[e].p.y, edges[e].q.y); };
+	auto maxY = [this](unsigned e) { return max(edges[e].p.y, edges[e].q.y); };
+	sort(byMinY.begin(), byMinY.end(), [&](unsigned e1, unsigned e2) { return minY(e1) < minY(e2); });
+
+	vector<unsigned> active;
+	size_t nextEdge = 0;
+	for ( unsigned q : queries ) {
+		GridPoint const &v = nodes[queryNodes[q]];
+
+		// Active edges span the line just below v: minY < v.y <= maxY
+		for ( ; nextEdge < byMinY.size() && minY(byMinY[nextEdge]) < v.y; ++nextEdge )
+			active.push_back(byMinY[nextEdge]);
+		active.erase(remove_if(active.begin(), active.end(), [&](unsigned e) { return maxY(e) < v.y; }),
+		             active.end());
+
+		for ( unsigned ei : active ) {
+			Edge const &e = edges[ei];
+
+			// Side of point v - (0, eps)
+			int side = orientSign(e.p, e.q, v);
+			if ( side == 0 )
+				side = e.q.x > e.p.x ? -1 : (e.q.x < e.p.x ? 1 : 0);
+
+			int sign = 0;
+			if ( e.p.y < v.y && v.y <= e.q.y && side > 0 )
+				sign = 1;
+			else if ( e.q.y < v.y && v.y <= e.p.y && side < 0 )
+				sign = -1;
+
+			for ( unsigned ch = 0; ch < channels; ++ch )
+				windings[q * channels + ch] += sign * e.delta[ch];
+		}
+	}
+}
+
+
+
+template <typename Inside>
+vector<Polygon> SnapOverlay::extract(Inside inside, bool allowHoles) const
+{
+	// Boundary half-edges have the region on the left
+	vector<bool> boundary(edges.size() * 2);
+	for ( unsigned h = 0; h < boundary.size(); ++h )
+		boundary[h] = inside(&windings[faceOf[h] * channels]) && ! inside(&windings[faceOf[h ^ 1] * channels]);
+
+	unsigned const noPos = ~0u;
+
+	vector<Polygon> rv;
+	vector<bool> used(boundary.size(), false);
+	vector<unsigned> ring;
+	vector<unsigned> ringPos(nodes.size(), noPos);   // Node -> position in ring
+
+	for ( unsigned h0 = 0; h0 < boundary.size(); ++h0 ) {
+		if ( ! boundary[h0] || used[h0] )
+			continue;
+
+		// Follow boundary, turning to the first boundary half-edge clockwise from the twin.
+		// Parts touching at a vertex are so traced separately, but a hole touching the outer
+		// contour, or holes touching each other, are traced in one pass through the common node.
+		// Such loops are cut off as separate rings when the node is reached again.
+		ring.clear();
+		unsigned h = h0;
+		do {
+			used[h] = true;
+
+			unsigned const n = origin(h);
+			if ( ringPos[n] == noPos ) {
+				ringPos[n] = unsigned(ring.size());
+				ring.push_back(n);
+			}
+			else {
+				unsigned const start = ringPos[n];
+				addRing(&ring[start], ring.size() - start, allowHoles, rv);
+				for ( size_t i = start + 1; i < ring.size(); ++i )
+					ringPos[ring[i]] = noPos;
+				ring.resize(start + 1);
+			}
+
+			unsigned const t = target(h);
+			unsigned pos = outPos[h ^ 1];
+			do
+				pos = pos > outStart[t] ? pos - 1 : outStart[t + 1] - 1;
+			while ( ! boundary[outEdges[pos]] );
+			h = outEdges[pos];
+		} while ( h != h0 );
+
+		addRing(ring.data(), ring.size(), allowHoles, rv);
+		for ( unsigned n : ring )
+			ringPos[n] = noPos;
+	}
+
+	return rv;
+}
+
+
+
+/// Add ring of nodes to results.
+/*!
+ * \param allowHoles  Add clockwise ring as hole instead of throwing.
+ */
+void SnapOverlay::addRing(unsigned const *ring, size_t size, bool allowHoles, vector<Polygon> &rv) const
+{
+	// Remove collinear vertices
+	vector<GridPoint> vertices;
+	for ( size_t i = 0; i < size; ++i ) {
+		GridPoint const &prev = nodes[ring[i > 0 ? i - 1 : size - 1]];
+		GridPoint const &next = nodes[ring[i + 1 < size ? i + 1 : 0]];
+		if ( orientSign(prev, nodes[ring[i]], next) != 0 )
+			vertices.push_back(nodes[ring[i]]);
+	}
+
+	// Holes go clockwise; area is exact in 128 bits
+	Wide area;
+	for ( size_t i = 0; i < vertices.size(); ++i ) {
+		GridPoint const &p = vertices[i], &q = vertices[i + 1 < vertices.size() ? i + 1 : 0];
+		area = area + Wide::product(p.x, q.y) - Wide::product(p.y, q.x);
+	}
+	bool const hole = area.sign() < 0;
+	if ( hole && ! allowHoles )
+		throw range_error("Resulting polygon contains holes");
+
+	vector<Point> points;
+	points.reserve(vertices.size());
+	for ( GridPoint const &p : vertices )
+		points.push_back(Point(p.x * gridStep, p.y * gridStep));
+
+	// With Y axis pointing down, the order reverses: outer contours are made
+	// counterclockwise, and holes become clockwise when reversed
+	if ( hole )
+		reverse(points.begin(), points.end());
+	Polygon polygon(move(points));
+	if ( ! hole )
+		polygon.makeCcw();
+	rv.push_back(move(polygon));
+}
+
+} // namespace
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+
+/// Overlay operands and extract requested results.
+//
+static BooleanResults evaluateSnapped(Polygon const &p1, Polygon const &p2, unsigned operations,
+                                      double gridStep, bool allowHoles)
+{
+	if ( ! (gridStep > 0) )
+		throw invalid_argument("Grid step must be positive");
+
+	SnapOverlay overlay(2, gridStep);
+	overlay.addContour(p1, 0, false);
+	overlay.addContour(p2, 1, false);
+	overlay.build();
+
+	BooleanResults rv;
+	if ( operations & BoolOp_Add )
+		rv.sum = overlay.extract([](int const *w) { return w[0] != 0 || w[1] != 0; }, allowHoles);
+	if ( operations & BoolOp_Intersect )
+		rv.intersection = overlay.extract([](int const *w) { return w[0] != 0 && w[1] != 0; }, allowHoles);
+	if ( operations & BoolOp_Subtract12 )
+		rv.difference12 = overlay.extract([](int const *w) { return w[0] != 0 && w[1] == 0; }, allowHoles);
+	if ( operations & BoolOp_Subtract21 )
+		rv.difference21 = overlay.extract([](int const *w) { return w[1] != 0 && w[0] == 0; }, allowHoles);
+	if ( operations & BoolOp_Xor )
+		rv.symDifference = overlay.extract([](int const *w) { return (w[0] != 0) != (w[1] != 0); },
+		                                   allowHoles);
+
+	return rv;
+}
+
+
+
+BooleanResults evaluateBoolean_Snapped(Polygon const &p1, Polygon const &p2, unsigned operations,
+                                       double gridStep)
+{
+	return evaluateSnapped(p1, p2, operations, gridStep, false);
+}
+
+
+
+BooleanRingResults evaluateBoolean_SnappedRings(Polygon const &p1, Polygon const &p2,
+                                                unsigned operations, double gridStep)
+{
+	return assembleRings(evaluateSnapped(p1, p2, operations, gridStep, true));
+}
+
+
+
+vector<Polygon> unionAll_Snapped(vector<Polygon const *> const &polygons, double gridStep)
+{
+	if ( ! (gridStep > 0) )
+		throw invalid_argument("Grid step must be positive");
+
+	// With all polygons oriented the same way, winding number is nonzero where any is
+	SnapOverlay overlay(1, gridStep);
+	for ( Polygon const *p : polygons )
+		if ( ! p->empty() )
+			overlay.addContour(*p, 0, ! p->isCcw());
+	overlay.build();
+
+	return overlay.extract([](int const *w) { return w[0] != 0; });
+}
+
+
+
+} // namespace poly
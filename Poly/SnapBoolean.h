@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Boolean.h"
+
+#include <cstdint>
+#include <vector>
+
+
+
+namespace poly {
+
+
+
+/*!
+ * Boolean operations on integer grid, with snap rounding
+ *
+ * Vertices of operands are rounded to the grid of given step. Crossing points of edges are
+ * rounded to the grid too, by snap rounding (J. D. Hobby, "Practical segment intersection with
+ * finite precision output"; L. Guibas, D. Marimont, "Rounding arrangements dynamically"):
+ * every edge passing through the unit square around a rounded point (hot pixel) is routed
+ * through that point. All computations are done on integer grid coordinates in exact 64-bit
+ * and 128-bit arithmetic, so the topology of results is always consistent.
+ *
+ * Unlike other boolean operations, these support touching of operands by edges and vertices.
+ * Shared edges are merged, and parts of result touching at a vertex are returned as separate
+ * polygons. Operands can also be self-intersecting, inside is defined by nonzero winding.
+ *
+ * Collinear vertices are removed from results. Result polygons are counterclockwise.
+ *
+ * Crossings of edges are found by testing pairs of edges overlapping in x, so finding them is
+ * O(n log n + P), where P is the number of such pairs. P is O(n) for operands with edges short
+ * relative to their extent, but up to O(n^2) for operands with many long edges, e.g. thin
+ * slivers spanning the whole width. Routing of edges through hot pixels is proportional to the
+ * number of hot pixels in their bounding boxes.
+ */
+
+
+/// Grid coordinates of snapped operations must not exceed this by absolute value.
+int64_t const MaxSnapCoordinate = int64_t(1) << 29;
+
+/// Compute several boolean operations on integer grid.
+/*!
+ * \param operations  Combination of BooleanOp flags.
+ * \param gridStep    Step of grid in polygon coordinates.
+ *
+ * \throw range_error If grid coordinates exceed MaxSnapCoordinate, or a result contains holes.
+ */
+BooleanResults evaluateBoolean_Snapped(Polygon const &p1, Polygon const &p2, unsigned operations,
+                                       double gridStep = 1);
+
+/// Compute several boolean operations on integer grid, with results as polygons with holes.
+/*!
+ * Holes touching outer ring or each other at a vertex are traced as separate rings.
+ *
+ * \throw range_error If grid coordinates exceed MaxSnapCoordinate.
+ */
+BooleanRingResults evaluateBoolean_SnappedRings(Polygon const &p1, Polygon const &p2,
+                                                unsigned operations, double gridStep = 1);
+
+/// Union of any number of polygons on integer grid, in one pass.
+/*!
+ * Suited for merging of adjacent polygons sharing edges, which unionAll() does not support.
+ *
+ * \param gridStep  Step of grid in polygon coordinates.
+ *
+ * \throw range_error If grid coordinates exceed MaxSnapCoordinate, or union contains holes.
+ */
+std::vector<Polygon> unionAll_Snapped(std::vector<Polygon const *> const &polygons, double gridStep = 1);
+
+
+
+} // namespace poly
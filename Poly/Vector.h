@@ -9,17 +9,20 @@ namespace poly {
 
 /// Vector from origin.
 //
-class Vector : public Point
+template <typename T>
+class BasicVector : public BasicPoint<T>
 {
 public:
-	Vector(double x, double y) : Point(x, y) {}
+	BasicVector(T x, T y) : BasicPoint<T>(x, y) {}
 	
-	Vector(Point const &p1, Point const &p2)
-		: Point(p2.x - p1.x, p2.y - p1.y) {}
+	BasicVector(BasicPoint<T> const &p1, BasicPoint<T> const &p2)
+		: BasicPoint<T>(p2.x - p1.x, p2.y - p1.y) {}
 
-	Vector operator-() const { return Vector(-x, -y); }
+	BasicVector operator-() const { return BasicVector(-this->x, -this->y); }
 };
 
+typedef BasicVector<double> Vector;
+
 
 
 /// Multiplication with scalar.
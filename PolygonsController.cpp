@@ -415,32 +415,10 @@ void PolygonsController::OnEditPartition()
 static poly::Polygon::ConstEdgeIterator testEdgeHit(poly::Polygon const &polygon,
                                                     poly::Point const &point)
 {
-	double dMin = DBL_MAX;
-	poly::Polygon::ConstEdgeIterator closestEdge = polygon.edgeEnd();
-
-	for ( auto edge = polygon.edgeBegin(); edge != polygon.edgeEnd(); ++edge ) {
-		// Need to hit inside edge segment, so use strict function
-		double const d = distanceSqr_Strict(point, *edge);
-		if ( d < dMin ) {
-			dMin = d;
-			closestEdge = edge;
-		}
-		if ( dMin == 0 )
-			break;
-	}
-
-	return dMin <= polygonSenseDistanceSqr ? closestEdge : polygon.edgeEnd();
-}
+	// Need to hit inside edge segment, so use strict distance
+	poly::EdgeDistance const hit = polygon.nearestEdge(point, polygonSenseDistanceSqr, true);
 
-
-
-/// Find polygon hit by given point.
-//
-static list<poly::Polygon>::const_iterator findHitPolygon(list<poly::Polygon> const &polygons,
-                                                          poly::Point const &point)
-{
-	return find_if(polygons.begin(), polygons.end(),
-	               [&point](poly::Polygon const &polygon){ return poly::inside(point, polygon); });
+	return hit.edge != poly::NoEdge ? polygon.edgeAt(hit.edge) : polygon.edgeEnd();
 }
 
 
@@ -521,7 +499,7 @@ _Mode_Idle:
 					}
 				}
 
-				auto const polygon = findHitPolygon(model->getPolygons(), point);
+				auto const polygon = model->findPolygonAt(point);
 				if ( polygon != model->getPolygons().end() ) {
 					model->setCurPolygon(polygon);
 					
@@ -123,13 +123,19 @@ public:
 		: polygonIdx(polygonIdx), vector(vector) {}
 
 	EventList apply(list<poly::Polygon> &polygons) override {
+		vector<Event> events(1, Event(Event::Polygon, Event::Modified, polygonIdx));
+
 		polygonByIdx(polygons, polygonIdx).translate(vector);
-		return EventList();
+
+		return EventList(move(events));
 	}
 
 	EventList undo(list<poly::Polygon> &polygons) override {
+		vector<Event> events(1, Event(Event::Polygon, Event::Modified, polygonIdx));
+
 		polygonByIdx(polygons, polygonIdx).translate(-vector);
-		return EventList();
+
+		return EventList(move(events));
 	}
 
 	using Action::apply;
@@ -222,20 +228,25 @@ public:
 		: polygonIdx(polygonIdx), vertexIdx(vertexIdx), vector(vector) {}
 
 	EventList apply(list<poly::Polygon> &polygons) override {
-		vertex(polygons) += vector;
-		return EventList();
+		vector<Event> events(1, Event(Event::Polygon, Event::Modified, polygonIdx));
+		moveVertex(polygons, vector);
+		return EventList(move(events));
 	}
 	EventList undo(list<poly::Polygon> &polygons) override {
-		vertex(polygons) -= vector;
-		return EventList();
+		vector<Event> events(1, Event(Event::Polygon, Event::Modified, polygonIdx));
+		moveVertex(polygons, -vector);
+		return EventList(move(events));
 	}
 
 	using Action::apply;
 	using Action::undo;
 
 private:
-	poly::Point & vertex(list<poly::Polygon> &polygons)
-		{ return * vertexIteratorByIdx(polygons, polygonIdx, vertexIdx); }
+	void moveVertex(list<poly::Polygon> &polygons, poly::Vector const &v) {
+		auto &polygon = polygonByIdx(polygons, polygonIdx);
+		auto const it = vertexIteratorByIdx(polygon, vertexIdx);
+		polygon.setVertex(it, *it + v);
+	}
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -532,6 +543,8 @@ void PolygonsDoc::Serialize(CArchive& ar)
 
 			d->polygons.push_back(move(polygon));
 		}
+
+		d->rebuildPolygonIndex();
 	}
 }
 
@@ -558,6 +571,17 @@ list<poly::Polygon> const & PolygonsDoc::getPolygons() const
 {	return d->polygons; }
 
 
+/// Find first polygon containing given point.
+/*!
+ * O(log n + k) on average, n - number of polygons, k - number of polygons whose bounding boxes
+ * contain the point.
+ *
+ * \return getPolygons().end() if there is no such polygon.
+ */
+list<poly::Polygon>::const_iterator PolygonsDoc::findPolygonAt(poly::Point const &point) const
+{ return d->findPolygonAt(point); }
+
+
 /// Tell if there is current polygon.
 ///
 bool PolygonsDoc::hasCurPolygon() const
@@ -1237,7 +1261,8 @@ void PolygonsDoc::CreatePolygonActionImpl::moveLastVertex(poly::Point const &pos
 	auto *const lastAction = getLastAction<Act_AddPolygon>();
 		
 	lastAction->undo(d->polygons, d);
-	lastAction->polygon().back() = pos;
+	auto &polygon = lastAction->polygon();
+	polygon.setVertex(prev(polygon.end()), pos);
 	lastAction->apply(d->polygons, d);
 
 	CUA_END_METHOD
@@ -1441,7 +1466,7 @@ public:
 	CurPolygonAddVertexAction(PolygonsDoc::Private *d, bool *modelLock,
 	                          VerticesCIterator beforeVertex)
 		: CompositeUserActionImpl(d, modelLock)
-		, beforeVertex(beforeVertex)
+		, beforeVertexIdx(d->curPolygonVertexIdx(beforeVertex))
 	{}
 
 private:
@@ -1456,7 +1481,8 @@ private:
 	CUA_OVERRIDES
 
 //
-	VerticesCIterator const beforeVertex;
+	// Index, since adding vertex invalidates iterators
+	UINT const beforeVertexIdx;
 };
 
 
@@ -1467,7 +1493,7 @@ void PolygonsDoc::CurPolygonAddVertexAction::step(poly::Point const &pos)
 
 	if ( ! hasActionInLog() ) {
 		pushActionToLog(unique_ptr<Action>(
-			new Act_AddVertex(d->curPolygonIdx(), d->curPolygonVertexIdx(beforeVertex), pos) ));
+			new Act_AddVertex(d->curPolygonIdx(), beforeVertexIdx, pos) ));
 	}
 	else {
 		auto *const lastAction = getLastAction<Act_AddVertex>();
@@ -1619,5 +1645,7 @@ BOOL PolygonsDoc::Private::loadFromDB(CDatabase *db)
 
 	recset.Close();
 
+	rebuildPolygonIndex();
+
 	return TRUE;
 }
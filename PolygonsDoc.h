@@ -160,6 +160,7 @@ public:
 // Attributes
 public:
 	std::list<poly::Polygon> const & getPolygons() const;
+	std::list<poly::Polygon>::const_iterator findPolygonAt(poly::Point const &point) const;
 	bool hasCurPolygon() const;
 	std::list<poly::Polygon>::const_iterator getCurPolygonIt() const;
 	poly::Polygon const & getCurPolygon() const;
@@ -234,7 +235,6 @@ private:
 
 	typedef std::list<poly::Polygon>::iterator       PolygonsIterator;
 	typedef std::list<poly::Polygon>::const_iterator PolygonsCIterator;
-	typedef poly::Polygon::iterator       VerticesIterator;
 	typedef poly::Polygon::const_iterator VerticesCIterator;
 
 //
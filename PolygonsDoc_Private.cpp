@@ -9,6 +9,9 @@
 
 #include "Lib/Iterators.h"
 
+#include <algorithm>
+#include <functional>
+
 
 using namespace std;
 
@@ -241,8 +244,31 @@ void PolygonsDoc::Private::setCurPolygonAndVertex(PolygonsCIterator polygonIt,
 
 
 
-/// Get polygons intersecting with current polygon.
+/// Find first polygon containing given point.
 /*!
+ * \return polygons.end() if there is no such polygon.
+ */
+PolygonsDoc::PolygonsCIterator PolygonsDoc::Private::findPolygonAt(poly::Point const &point) const
+{
+	// Overlapping polygons are resolved in favor of the first one in the list
+	PolygonsCIterator first = polygons.end();
+	ULONGLONG firstOrder = ULLONG_MAX;
+
+	polygonIndex.query(point, [&](poly::Rect const &, PolygonRef const &ref) {
+		if ( ref.order < firstOrder && ref.polygon->locate(point) != poly::PointLoc_Outside ) {
+			first = ref.it;
+			firstOrder = ref.order;
+		}
+	});
+
+	return first;
+}
+
+
+
+/// Get polygons intersecting with current polygon.
+/*! Polygons are returned in no particular order.
+ *
  * \throw state_error If no current polygon.
  */
 vector<PolygonsDoc::PolygonsCIterator> PolygonsDoc::Private::getPolygonsIntersectingWithCur() const
@@ -252,13 +278,13 @@ vector<PolygonsDoc::PolygonsCIterator> PolygonsDoc::Private::getPolygonsIntersec
 
 	vector<PolygonsCIterator> rv;
 	
-	for ( auto it = polygons.begin(); it != polygons.end(); ++it ) {
-		if ( it == curPolygonIt )
-			continue;
+	polygonIndex.query(curPolygonIt->boundingBox(), [&](poly::Rect const &, PolygonRef const &ref) {
+		if ( ref.it == curPolygonIt )
+			return;
 
-		if ( poly::intersects(*curPolygonIt, *it) )
-			rv.push_back(it);
-	}
+		if ( poly::intersects(*curPolygonIt, *ref.polygon) )
+			rv.push_back(ref.it);
+	});
 
 	return rv;
 }
@@ -383,10 +409,120 @@ void PolygonsDoc::Private::commitLastAction()
 
 
 
+/// Index all polygons anew.
+//
+void PolygonsDoc::Private::rebuildPolygonIndex()
+{
+	polygonIndex.clear();
+	indexedPolygons.clear();
+	indexedPolygons.reserve(polygons.size());
+
+	for ( auto it = polygons.cbegin(); it != polygons.cend(); ++it ) {
+		indexedPolygons.push_back(IndexedPolygon());
+		indexedPolygons.back().ref.polygon = &*it;
+		indexedPolygons.back().ref.it = it;
+		indexedPolygons.back().ref.order = indexedPolygons.size() * PolygonOrderStep;
+		reindexPolygon(indexedPolygons.size() - 1);
+	}
+}
+
+
+/// Bring polygon index in accordance with changes described by events.
+/*!
+ * O(log n) per changed polygon, plus moving of n indices on addition and deletion. Order keys
+ * are renumbered in O(n log n) when there is no room for added polygon, which takes at least
+ * 20 insertions between the same neighbours.
+ */
+void PolygonsDoc::Private::updatePolygonIndex(EventList const &events)
+{
+	vector<UINT> deleted, added, modified;
+	for ( Event const &event : events ) {
+		if ( event.object == Event::Polygon && event.action == Event::Deleted )
+			deleted.push_back(event.polygonIdx);
+		else if ( event.object == Event::Polygon && event.action == Event::Added )
+			added.push_back(event.polygonIdx);
+		else   // Polygon modified or its vertices added / deleted
+			modified.push_back(event.polygonIdx);
+	}
+
+	// Deleted indices are as before the action, so delete from the end
+	sort(deleted.begin(), deleted.end(), greater<UINT>());
+	for ( UINT idx : deleted ) {
+		polygonIndex.remove(indexedPolygons[idx].bbox, indexedPolygons[idx].ref);
+		indexedPolygons.erase(indexedPolygons.begin() + idx);
+	}
+
+	// Added indices are as after the action, so add from the beginning
+	bool renumber = false;
+	sort(added.begin(), added.end());
+	for ( UINT idx : added ) {
+		// Added polygons are mostly at the end
+		auto const it = idx < polygons.size() / 2 ? next(polygons.cbegin(), idx)
+		                                          : prev(polygons.cend(), polygons.size() - idx);
+		
+		indexedPolygons.insert(indexedPolygons.begin() + idx, IndexedPolygon());
+		indexedPolygons[idx].ref.polygon = &*it;
+		indexedPolygons[idx].ref.it = it;
+		if ( ! orderPolygon(idx) )
+			renumber = true;
+		reindexPolygon(idx);
+	}
+
+	sort(modified.begin(), modified.end());
+	modified.erase(unique(modified.begin(), modified.end()), modified.end());
+	for ( UINT idx : modified ) {
+		polygonIndex.remove(indexedPolygons[idx].bbox, indexedPolygons[idx].ref);
+		reindexPolygon(idx);
+	}
+
+	ASSERT(indexedPolygons.size() == polygons.size());
+
+	if ( renumber )
+		rebuildPolygonIndex();
+}
+
+
+/// Assign order key to added polygon, between keys of its neighbours.
+/*!
+ * Polygons are added in order of indices, so the next one is already ordered.
+ *
+ * \return false If there is no room between neighbours, and the key is not in order.
+ */
+bool PolygonsDoc::Private::orderPolygon(UINT idx)
+{
+	ULONGLONG const prevOrder = idx > 0 ? indexedPolygons[idx - 1].ref.order : 0;
+	ULONGLONG const nextOrder = idx + 1 < indexedPolygons.size() ? indexedPolygons[idx + 1].ref.order
+	                                                             : prevOrder + 2 * PolygonOrderStep;
+
+	indexedPolygons[idx].ref.order = prevOrder + (nextOrder - prevOrder) / 2;
+	return nextOrder - prevOrder >= 2;
+}
+
+
+/// Insert polygon to index under its current bounding box.
+/*! \pre Polygon is not in index.
+ */
+void PolygonsDoc::Private::reindexPolygon(UINT idx)
+{
+	IndexedPolygon &indexed = indexedPolygons[idx];
+
+	if ( indexed.ref.polygon->empty() ) {
+		indexed.bbox = poly::Rect(poly::Point(0, 0), poly::Point(0, 0));
+		return;
+	}
+
+	indexed.bbox = indexed.ref.polygon->boundingBox();
+	polygonIndex.insert(indexed.bbox, indexed.ref);
+}
+
+
+
 // PresentationModel override
 //
 void PolygonsDoc::Private::notify(EventList const &events)
 {
+	updatePolygonIndex(events);
+
 	// Reset selection if selected object is deleted
 	if ( _curPolygonIdx != UINT_MAX && events.polygonDeleted(_curPolygonIdx) )
 		doResetCurPolygon();
@@ -394,6 +530,15 @@ void PolygonsDoc::Private::notify(EventList const &events)
 	          events.vertexDeleted(_curPolygonIdx, _curVertexIdx) )
 		doResetCurVertex();
 
+	// Adding and deleting vertices invalidates iterators to vertices of the polygon, so current
+	// vertex is found again by index
+	if ( _curPolygonIdx != UINT_MAX && events.verticesChanged(_curPolygonIdx) ) {
+		_curVertexIdx = _curVertexIdx == UINT_MAX ? UINT_MAX
+		                                          : events.vertexIdxAfter(_curPolygonIdx, _curVertexIdx);
+		curVertexIt = _curVertexIdx == UINT_MAX ? curPolygonIt->end()
+		                                        : next(curPolygonIt->begin(), _curVertexIdx);
+	}
+
 	// Select added object
 	if ( events.numAddedPolygons() == 1 )
 		doSetCurPolygon(events.getPolygonAddedEvent().polygonIdx);
@@ -4,6 +4,8 @@
 #include "PresentationModel.h"
 #include "Actions.h"
 
+#include "Poly/RTree.h"
+
 #include <deque>
 #include <memory>
 
@@ -56,6 +58,7 @@ class PolygonsDoc::Private : public PresentationModel
 
 	void recalcCurIndices();
 
+	PolygonsCIterator findPolygonAt(poly::Point const &point) const;
 	std::vector<PolygonsCIterator> getPolygonsIntersectingWithCur() const;
 	UINT getIntersectingPolygonIdx() const;
 
@@ -72,6 +75,11 @@ class PolygonsDoc::Private : public PresentationModel
 	// PresentationModel override
 	void notify(EventList const &events) override;
 
+	void rebuildPolygonIndex();
+	void updatePolygonIndex(EventList const &events);
+	bool orderPolygon(UINT idx);
+	void reindexPolygon(UINT idx);
+
 	void restoreSelectionBefore(Action const *action);
 	void restoreSelectionAfter (Action const *action);
 
@@ -83,6 +91,31 @@ class PolygonsDoc::Private : public PresentationModel
 
 	std::list<poly::Polygon> polygons;
 
+	// Spatial index of polygons by bounding boxes, kept in sync with polygons by notify().
+	// indexedPolygons is parallel to polygons and holds boxes under which polygons are indexed.
+
+	// Polygon is identified by address, because iterators of deleted polygons cannot be compared.
+	// Order keys increase along polygons list, so that the first of overlapping polygons is found
+	// without walking the list. Keys are spaced by PolygonOrderStep and renumbered when there
+	// is no room between neighbours of inserted polygon.
+	struct PolygonRef {
+		poly::Polygon const *polygon;
+		PolygonsCIterator it;
+		ULONGLONG order;
+
+		bool operator==(PolygonRef const &r) const { return polygon == r.polygon; }
+	};
+
+	static ULONGLONG const PolygonOrderStep = 1 << 20;
+
+	struct IndexedPolygon {
+		PolygonRef ref;
+		poly::Rect bbox;   ///< Meaningless for empty polygon, which is not indexed.
+	};
+
+	poly::RTree<PolygonRef> polygonIndex;
+	std::vector<IndexedPolygon> indexedPolygons;
+
 	// Application layer state
 	
 	std::deque<std::unique_ptr<Action>> actionLog;
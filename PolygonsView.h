@@ -7,7 +7,7 @@
 class PolygonsDoc;
 class PolygonsController;
 
-namespace poly { class Point; }
+namespace poly { template <typename T> class BasicPoint;  typedef BasicPoint<double> Point; }
 
 
 
@@ -0,0 +1,295 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/Boolean.h"
+#include "../Poly/PreparedPolygon.h"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+using namespace poly;
+
+
+
+static Polygon polygon(std::vector<double> const &coords)
+{
+	std::vector<Point> vertices;
+	for ( size_t i = 0; i + 1 < coords.size(); i += 2 )
+		vertices.push_back(Point(coords[i], coords[i+1]));
+	return Polygon(std::move(vertices));
+}
+
+
+
+template <typename Operation>
+static bool throwsRangeError(Operation operation)
+{
+	try {
+		operation();
+	}
+	catch ( std::range_error const & ) {
+		return true;
+	}
+	return false;
+}
+
+
+
+// Subtrahend inside minuend without crossings makes a hole, which was silently lost
+TEST(Boolean_NestedSubtrahendThrows)
+{
+	Polygon const big = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const small = polygon({2,2, 5,2, 5,5, 2,5});
+
+	CHECK(throwsRangeError([&]() { subtract(big, small); }));
+	CHECK(throwsRangeError([&]() { xor(big, small); }));
+	CHECK(throwsRangeError([&]() { xor(small, big); }));
+	CHECK(throwsRangeError([&]() { partition(big, small); }));
+	CHECK(throwsRangeError([&]() { evaluateBoolean(big, small, BoolOp_Subtract12); }));
+	CHECK(throwsRangeError([&]() { evaluateBoolean(small, big, BoolOp_Subtract21); }));
+	CHECK(throwsRangeError([&]() { evaluateBoolean(big, small, BoolOp_Xor); }));
+
+	CHECK(subtract(small, big).empty());
+	CHECK(partition(small, big).size() == 1);
+
+	BooleanResults const r =
+		evaluateBoolean(big, small, BoolOp_Add | BoolOp_Intersect | BoolOp_Subtract21);
+	CHECK(r.sum.size() == 1 && std::abs(r.sum.front().signedArea()) == 100);
+	CHECK(r.intersection.size() == 1 && std::abs(r.intersection.front().signedArea()) == 9);
+	CHECK(r.difference21.empty());
+}
+
+
+
+TEST(BooleanRings_NestedSubtrahend)
+{
+	Polygon const big = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const small = polygon({2,2, 5,2, 5,5, 2,5});
+
+	BooleanRingResults const r = evaluateBoolean_Rings(big, small, BoolOp_Subtract12 | BoolOp_Xor);
+	CHECK(r.difference12.size() == 1);
+	CHECK(r.symDifference.size() == 1);
+	if ( r.difference12.size() != 1 || r.symDifference.size() != 1 )
+		return;
+
+	CHECK(r.difference12.front().numHoles() == 1);
+	CHECK(r.difference12.front().area() == 91);
+	CHECK(r.symDifference.front().numHoles() == 1);
+	CHECK(r.symDifference.front().area() == 91);
+}
+
+
+
+TEST(UnionAll_ChainAndContained)
+{
+	std::vector<Polygon> polygons;
+	polygons.push_back(polygon({0,0, 10,0, 10,10, 0,10}));
+	polygons.push_back(polygon({5,1, 15,1, 15,9, 5,9}));
+	polygons.push_back(polygon({12,2, 22,2, 22,8, 12,8}));
+	polygons.push_back(polygon({1,1, 3,1, 3,3, 1,3}));
+	polygons.push_back(polygon({30,0, 31,0, 31,1, 30,1}));
+
+	std::vector<Polygon> const u = unionAll(polygons.begin(), polygons.end());
+	CHECK(u.size() == 2);
+
+	double area = 0;
+	for ( Polygon const &p : u )
+		area += std::abs(p.signedArea());
+	CHECK(area == 100 + 5*8 + 7*6 + 1);
+}
+
+
+
+// Sum of operands without crossings was taken for a polygon with holes
+TEST(Boolean_AddDisjoint)
+{
+	Polygon const s1 = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const s2 = polygon({20,0, 25,0, 25,5, 20,5});
+
+	std::vector<Polygon> const sum = add(s1, s2);
+	CHECK(sum.size() == 2);
+	for ( Polygon const &p : sum )
+		CHECK(p.isCcw());
+
+	BooleanResults const r = evaluateBoolean(s1, s2, BoolOp_Add | BoolOp_Intersect);
+	CHECK(r.sum.size() == 2);
+	CHECK(r.intersection.empty());
+
+	// Bounding boxes overlap
+	Polygon const l = polygon({0,0, 10,0, 10,2, 2,2, 2,10, 0,10});
+	Polygon const s3 = polygon({5,5, 9,5, 9,9, 5,9});
+	CHECK(add(l, s3).size() == 2);
+	CHECK(add(s3, l).size() == 2);
+}
+
+
+
+TEST(Boolean_AddEnclosingHoleThrows)
+{
+	Polygon const u = polygon({0,0, 10,0, 10,10, 7,10, 7,3, 3,3, 3,10, 0,10});
+	Polygon const bar = polygon({-1,8, 11,8, 11,12, -1,12});
+
+	CHECK(throwsRangeError([&]() { add(u, bar); }));
+	CHECK(throwsRangeError([&]() { evaluateBoolean(u, bar, BoolOp_Add); }));
+
+	BooleanRingResults const r = evaluateBoolean_Rings(u, bar, BoolOp_Add);
+	CHECK(r.sum.size() == 1 && r.sum.front().numHoles() == 1);
+}
+
+
+
+static bool samePolygons(std::vector<Polygon> const &r1, std::vector<Polygon> const &r2)
+{
+	if ( r1.size() != r2.size() )
+		return false;
+	for ( size_t i = 0; i < r1.size(); ++i ) {
+		if ( ! std::equal(r1[i].begin(), r1[i].end(), r2[i].begin(), r2[i].end()) )
+			return false;
+	}
+	return true;
+}
+
+
+
+/// Result of operation, or nothing if it throws.
+//
+template <typename Operation>
+static std::pair<bool, std::vector<Polygon>> tryOperation(Operation operation)
+{
+	try {
+		return std::make_pair(true, operation());
+	}
+	catch ( std::exception const & ) {
+		return std::make_pair(false, std::vector<Polygon>());
+	}
+}
+
+
+
+/// Test that convex method of finding intersections does not change results.
+//
+static void checkConvexDispatch(Polygon const &p1, Polygon const &p2)
+{
+	typedef std::pair<bool, std::vector<Polygon>> Result;
+	Result results[2][2];
+	for ( int convex = 0; convex < 2; ++convex ) {
+		setConvexIntersections(convex != 0);
+		results[convex][0] = tryOperation([&]() { return intersect(p1, p2); });
+		results[convex][1] = tryOperation([&]() { return add(p1, p2); });
+	}
+	setConvexIntersections(true);
+
+	for ( int op = 0; op < 2; ++op ) {
+		CHECK(results[0][op].first == results[1][op].first);
+		CHECK(samePolygons(results[0][op].second, results[1][op].second));
+	}
+}
+
+
+
+TEST(Boolean_ConvexIntersectionsSameResults)
+{
+	std::mt19937 rng(5);
+
+	unsigned evaluated = 0;
+	for ( unsigned i = 0; i < 2000; ++i ) {
+		double const size = i % 2 == 0 ? 40 : 1000;
+		Polygon const p1 = i % 4 == 0 ? test::randomRect(rng, unsigned(size))
+		                              : test::randomConvex(rng, 3 + rng() % 30, Point(0, 0), size);
+		Polygon p2 = test::randomConvex(rng, 3 + rng() % 30, Point(rng() % unsigned(size), 0), size);
+		if ( i % 3 == 0 )
+			p2 = test::reversed(p2);
+		if ( ! p1.isConvex() || ! p2.isConvex() )
+			continue;
+
+		checkConvexDispatch(p1, p2);
+		checkConvexDispatch(p2, p1);
+		++evaluated;
+	}
+	CHECK(evaluated > 1500);
+	CHECK(getConvexIntersections());
+}
+
+
+
+/// Evaluate, unless evaluation throws.
+//
+template <typename Evaluation>
+static bool tryEvaluate(Evaluation evaluation, BooleanResults &results)
+{
+	try {
+		results = evaluation();
+	}
+	catch ( std::exception const & ) {
+		return false;
+	}
+	return true;
+}
+
+
+
+/// Test operations with prepared operand on each side against plain ones.
+//
+static void checkPrepared(Polygon const &p1, Polygon const &p2)
+{
+	PreparedPolygon const pp1(p1), pp2(p2);
+
+	typedef std::vector<Polygon> (*Operation)(Polygon const &, Polygon const &);
+	typedef std::vector<Polygon> (*Operation1)(PreparedPolygon const &, Polygon const &);
+	typedef std::vector<Polygon> (*Operation2)(Polygon const &, PreparedPolygon const &);
+	struct { Operation plain; Operation1 prepared1; Operation2 prepared2; } const operations[] = {
+		{ &add, &add, &add },
+		{ &intersect, &intersect, &intersect },
+		{ &subtract, &subtract, &subtract },
+		{ &xor, &xor, &xor },
+	};
+	for ( auto const &op : operations ) {
+		auto const expected = tryOperation([&]() { return op.plain(p1, p2); });
+		auto const r1 = tryOperation([&]() { return op.prepared1(pp1, p2); });
+		auto const r2 = tryOperation([&]() { return op.prepared2(p1, pp2); });
+		CHECK(r1.first == expected.first && samePolygons(r1.second, expected.second));
+		CHECK(r2.first == expected.first && samePolygons(r2.second, expected.second));
+	}
+
+	unsigned const all = BoolOp_Add | BoolOp_Intersect | BoolOp_Subtract12 | BoolOp_Subtract21 |
+	                     BoolOp_Xor;
+	for ( unsigned operations : {all, unsigned(BoolOp_Intersect), unsigned(BoolOp_Subtract21)} ) {
+		BooleanResults expected, r1, r2;
+		bool const evaluated = tryEvaluate([&]() { return evaluateBoolean(p1, p2, operations); }, expected);
+		CHECK(tryEvaluate([&]() { return evaluateBoolean(pp1, p2, operations); }, r1) == evaluated);
+		CHECK(tryEvaluate([&]() { return evaluateBoolean(p1, pp2, operations); }, r2) == evaluated);
+
+		for ( BooleanResults const *r : {&r1, &r2} ) {
+			CHECK(samePolygons(r->sum, expected.sum));
+			CHECK(samePolygons(r->intersection, expected.intersection));
+			CHECK(samePolygons(r->difference12, expected.difference12));
+			CHECK(samePolygons(r->difference21, expected.difference21));
+			CHECK(samePolygons(r->symDifference, expected.symDifference));
+		}
+	}
+}
+
+
+
+TEST(Boolean_PreparedSameResults)
+{
+	std::mt19937 rng(14);
+
+	unsigned checked = 0;
+	for ( unsigned i = 0; i < 300; ++i ) {
+		Polygon p1 = test::randomStar(rng, 5 + rng() % 100, Point(0, 0), 1000);
+		Polygon p2 = test::randomStar(rng, 5 + rng() % 100, Point(rng() % 1000, rng() % 1000), 1000);
+		if ( ! p1.isSimple() || ! p2.isSimple() )
+			continue;
+		// Prepared operand is a counterclockwise copy
+		if ( i % 2 == 0 )
+			p1 = test::reversed(p1);
+		if ( i % 3 == 0 )
+			p2 = test::reversed(p2);
+
+		checkPrepared(p1, p2);
+		++checked;
+	}
+	CHECK(checked > 200);
+}
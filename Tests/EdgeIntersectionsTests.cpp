@@ -0,0 +1,245 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/EdgeIntersections.h"
+#include "../Poly/Functions.h"
+
+#include <random>
+
+using namespace poly;
+
+
+
+static bool sameIntersections(std::vector<EdgeIntersection> const &r1,
+                              std::vector<EdgeIntersection> const &r2)
+{
+	if ( r1.size() != r2.size() )
+		return false;
+	for ( size_t i = 0; i < r1.size(); ++i ) {
+		if ( r1[i].edge1 != r2[i].edge1 || r1[i].edge2 != r2[i].edge2 || r1[i].shape != r2[i].shape )
+			return false;
+	}
+	return true;
+}
+
+
+
+static Polygon polygon(std::vector<double> const &coords)
+{
+	std::vector<Point> vertices;
+	for ( size_t i = 0; i + 1 < coords.size(); i += 2 )
+		vertices.push_back(Point(coords[i], coords[i+1]));
+	return Polygon(std::move(vertices));
+}
+
+
+
+/// Test sweep against brute force for both windings of operands.
+//
+static void checkSweep(Polygon const &p1, Polygon const &p2)
+{
+	CHECK(sameIntersections(findEdgeIntersections_Sweep(p1, p2),
+	                        findEdgeIntersections_BruteForce(p1, p2)));
+
+	Polygon const r1 = test::reversed(p1), r2 = test::reversed(p2);
+	CHECK(sameIntersections(findEdgeIntersections_Sweep(r1, r2),
+	                        findEdgeIntersections_BruteForce(r1, r2)));
+}
+
+
+
+/// Test parallel sweep against brute force, in one and several threads.
+//
+static void checkParallelSweep(Polygon const &p1, Polygon const &p2)
+{
+	std::vector<EdgeIntersection> const expected = findEdgeIntersections_BruteForce(p1, p2);
+	CHECK(sameIntersections(findEdgeIntersections_ParallelSweep(p1, p2, 1), expected));
+	CHECK(sameIntersections(findEdgeIntersections_ParallelSweep(p1, p2, 4), expected));
+}
+
+
+
+// Rounded crossing point fell beyond right endpoint of an edge ending in a vertex shared with
+// the next edge, and the ended edge was inserted back into status
+TEST(Sweep_CrossingNearSharedVertex)
+{
+	Polygon const p1 = polygon({315,200, 469,257, 401,289, 313,282, 288,298, 348,457, 228,288,
+		224,426, 189,304, 127,425, 86,397, 136,271, -22,361, 63,261, 29,236, -47,200, -85,139,
+		32,125, 3,57, 7,-14, 74,-19, 160,77, 185,54, 216,52, 247,55, 334,-31, 388,-9, 317,115,
+		436,95, 327,173});
+	Polygon const p2 = polygon({476,200, 410,220, 393,237, 425,267, 421,291, 396,303, 373,313,
+		352,320, 352,350, 375,427, 295,330, 328,475, 291,460, 250,362, 232,406, 211,388, 209,301,
+		171,374, 187,294, 164,308, 54,423, 60,372, 19,370, 19,334, 133,248, 31,270, -22,258,
+		86,216, -13,200, 91,184, -36,139, 146,170, -15,81, 108,122, 102,96, 31,-1, 118,56, 125,30,
+		111,-51, 153,-26, 170,-72, 212,19, 232,14, 245,82, 293,-69, 279,65, 287,87, 336,35,
+		300,115, 425,7, 461,17, 402,93, 467,87, 351,158, 467,146, 456,175});
+
+	CHECK(findEdgeIntersections_BruteForce(p1, p2).size() == 20);
+	checkSweep(p1, p2);
+	checkParallelSweep(p1, p2);
+}
+
+
+
+// Rounded crossing point with vertical edge was off its x
+TEST(Sweep_CrossingWithVerticalEdge)
+{
+	Polygon const p1 = polygon({880,200, 902,441, 626,532, 575,774, 575,787, 170,564, 65,564,
+		65,557, -413,557, -539,323, -579,70, -579,-242, -260,-299, -97,-299, -97,-438, 321,-438,
+		321,-207, 596,-108, 586,-108});
+	Polygon const p2 = polygon({803,263, 803,490, 803,690, 136,921, -146,921, -653,522, -172,145,
+		20,19, 20,-556, 393,-92, 883,-156});
+
+	CHECK(findEdgeIntersections_BruteForce(p1, p2).size() == 8);
+	checkSweep(p1, p2);
+	checkParallelSweep(p1, p2);
+}
+
+
+
+TEST(Sweep_RandomPolygons)
+{
+	std::mt19937 rng(1);
+
+	for ( unsigned i = 0; i < 2000; ++i ) {
+		bool const axisAligned = i % 2 != 0;
+		double const radius = (i / 2) % 3 == 0 ? 30 : 1000;
+		Polygon const p1 = test::randomStar(rng, 5 + rng() % 30, Point(0, 0), radius, axisAligned);
+		Polygon const p2 = test::randomStar(rng, 5 + rng() % 100,
+		                                    Point(rng() % unsigned(radius), rng() % unsigned(radius)),
+		                                    radius, axisAligned);
+		if ( p1.isSimple() && p2.isSimple() )
+			checkSweep(p1, p2);
+	}
+}
+
+
+
+// Parallel sweep splits edges of the first polygon into chunks of SweepChunkEdges
+TEST(ParallelSweep_RandomPolygons)
+{
+	std::mt19937 rng(2);
+
+	for ( unsigned i = 0; i < 20; ++i ) {
+		bool const axisAligned = i % 2 != 0;
+		Polygon const p1 = test::randomStar(rng, 2000 + rng() % 3000, Point(0, 0), 100000,
+		                                    axisAligned);
+		Polygon const p2 = test::randomStar(rng, 100 + rng() % 3000,
+		                                    Point(rng() % 100000, rng() % 100000), 100000, axisAligned);
+		if ( p1.isSimple() && p2.isSimple() ) {
+			checkParallelSweep(p1, p2);
+			checkParallelSweep(p2, p1);
+		}
+	}
+}
+
+
+
+/// Test non-adjacent edges of polygon pairwise.
+//
+static bool hasSelfIntersections_Pairwise(Polygon const &polygon)
+{
+	std::vector<Segment> edges;
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it )
+		edges.push_back(*it);
+	unsigned const n = unsigned(edges.size());
+
+	for ( unsigned i = 0; i + 2 < n; ++i ) {
+		for ( unsigned j = i + 2; j < (i == 0 ? n - 1 : n); ++j ) {
+			if ( intersects(edges[i], edges[j]) )
+				return true;
+		}
+	}
+	return false;
+}
+
+
+
+TEST(ShamosHoey_RandomPolygons)
+{
+	std::mt19937 rng(3);
+
+	unsigned simple = 0;
+	for ( unsigned i = 0; i < 3000; ++i ) {
+		unsigned const n = 4 + rng() % 40;
+		Polygon const p = i % 2 == 0 ? test::randomPolygon(rng, n, 1000)
+		                             : test::randomStar(rng, n, Point(0, 0), 1000);
+		bool const expected = hasSelfIntersections_Pairwise(p);
+		CHECK(hasSelfIntersections_Sweep(p) == expected);
+		CHECK(hasSelfIntersections_Sweep(test::reversed(p)) == expected);
+		if ( ! expected )
+			++simple;
+	}
+
+	// Both outcomes are covered
+	CHECK(simple > 100 && simple < 2900);
+}
+
+
+
+/// Test convex method against brute force for all windings of operands.
+//
+static void checkConvex(Polygon const &p1, Polygon const &p2)
+{
+	Polygon const r1 = test::reversed(p1), r2 = test::reversed(p2);
+	CHECK(sameIntersections(findEdgeIntersections_Convex(p1, p2), findEdgeIntersections_BruteForce(p1, p2)));
+	CHECK(sameIntersections(findEdgeIntersections_Convex(r1, p2), findEdgeIntersections_BruteForce(r1, p2)));
+	CHECK(sameIntersections(findEdgeIntersections_Convex(p1, r2), findEdgeIntersections_BruteForce(p1, r2)));
+	CHECK(sameIntersections(findEdgeIntersections_Convex(r1, r2), findEdgeIntersections_BruteForce(r1, r2)));
+}
+
+
+
+TEST(Convex_RandomPolygons)
+{
+	std::mt19937 rng(4);
+
+	// Small sizes make collinear and touching edges and vertices common
+	unsigned overlaps = 0, touches = 0;
+	for ( unsigned i = 0; i < 3000; ++i ) {
+		double const size = i % 3 == 0 ? 6 : i % 3 == 1 ? 40 : 1000;
+		Polygon const p1 = i % 4 == 0 ? test::randomRect(rng, unsigned(size))
+		                              : test::randomConvex(rng, 3 + rng() % 30, Point(0, 0), size);
+		Polygon const p2 = i % 2 == 0 ? test::randomRect(rng, unsigned(size))
+		                              : test::randomConvex(rng, 3 + rng() % 30,
+		                                                   Point(rng() % unsigned(size), 0), size);
+		if ( ! p1.isConvex() || ! p2.isConvex() )
+			continue;
+
+		checkConvex(p1, p2);
+		checkConvex(p2, p1);
+
+		for ( EdgeIntersection const &isect : findEdgeIntersections_BruteForce(p1, p2) ) {
+			if ( isect.shape == Isect_Segment )
+				++overlaps;
+			else if ( isect.p1 == p1[isect.edge1] || isect.p1 == p2[isect.edge2] )
+				++touches;
+		}
+	}
+
+	// Degenerate cases are covered
+	CHECK(overlaps > 100 && touches > 100);
+}
+
+
+
+// Hulls touching by collinear edges and by vertices
+TEST(Convex_TouchingHulls)
+{
+	Polygon const square = polygon({0,0, 10,0, 10,10, 0,10});
+	std::vector<std::vector<double>> const others = {
+		{10,0, 20,0, 20,10, 10,10},      // shared edge
+		{10,5, 20,5, 20,15, 10,15},      // partially shared edge
+		{10,-5, 20,-5, 20,20, 10,20},    // edge containing edge
+		{10,10, 20,10, 20,20, 10,20},    // shared vertex
+		{10,5, 15,0, 20,5, 15,10},       // vertex on edge
+		{5,5, 15,-5, 25,5, 15,15},       // crossing
+		{2,2, 8,2, 8,8, 2,8},            // inside
+		{0,0, 10,0, 10,10, 0,10},        // the same
+	};
+	for ( auto const &coords : others ) {
+		Polygon const p = polygon(coords);
+		checkConvex(square, p);
+		checkConvex(p, square);
+	}
+}
@@ -0,0 +1,144 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/EdgeTree.h"
+#include "../Poly/Functions.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+using namespace poly;
+
+
+
+/// Distances to all edges, by the same formula as of EdgeTree, DBL_MAX for edges skipped in
+/// strict mode.
+//
+static std::vector<EdgeDistance> allDistances(Point const &p, Polygon const &polygon, bool strict)
+{
+	std::vector<EdgeDistance> rv;
+	unsigned idx = 0;
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it, ++idx ) {
+		Segment const s = *it;
+		Vector const d = s.toVector(), w(s.p1, p);
+		double const t = dotProduct(w, d), len2 = dotProduct(d, d);
+
+		double dist;
+		if ( t < 0 )
+			dist = strict ? DBL_MAX : distanceSqr(p, s.p1);
+		else if ( t > len2 )
+			dist = strict ? DBL_MAX : distanceSqr(p, s.p2);
+		else if ( len2 == 0 )
+			dist = distanceSqr(p, s.p1);
+		else {
+			double const cross = perpDotProduct(d, w);
+			dist = cross * cross / len2;
+		}
+		EdgeDistance const ed = { idx, dist };
+		rv.push_back(ed);
+	}
+	return rv;
+}
+
+
+
+static bool distanceLess(EdgeDistance const &d1, EdgeDistance const &d2)
+{
+	return d1.distanceSqr < d2.distanceSqr || (d1.distanceSqr == d2.distanceSqr && d1.edge < d2.edge);
+}
+
+
+
+static bool sameDistances(std::vector<EdgeDistance> const &r1, std::vector<EdgeDistance> const &r2)
+{
+	if ( r1.size() != r2.size() )
+		return false;
+	for ( size_t i = 0; i < r1.size(); ++i ) {
+		if ( r1[i].edge != r2[i].edge || r1[i].distanceSqr != r2[i].distanceSqr )
+			return false;
+	}
+	return true;
+}
+
+
+
+/// Test queries of tree against distances to all edges.
+//
+static void checkQueries(EdgeTree const &tree, Polygon const &polygon, Point const &p,
+                         double maxDistanceSqr, bool strict)
+{
+	// Found edges, ordered by distance
+	std::vector<EdgeDistance> expected;
+	for ( EdgeDistance const &ed : allDistances(p, polygon, strict) ) {
+		if ( ed.distanceSqr <= maxDistanceSqr && ed.distanceSqr < DBL_MAX )
+			expected.push_back(ed);
+	}
+	std::sort(expected.begin(), expected.end(), distanceLess);
+
+	EdgeDistance const nearest = tree.nearest(p, maxDistanceSqr, strict);
+	if ( expected.empty() )
+		CHECK(nearest.edge == NoEdge);
+	else
+		CHECK(nearest.edge == expected.front().edge && nearest.distanceSqr == expected.front().distanceSqr);
+
+	for ( unsigned k : {0u, 1u, 3u, 10u, polygon.numVertices() + 5} ) {
+		std::vector<EdgeDistance> const kNearest(expected.begin(),
+		                                         expected.begin() + std::min<size_t>(k, expected.size()));
+		CHECK(sameDistances(tree.nearest(p, k, maxDistanceSqr, strict), kNearest));
+	}
+
+	std::vector<EdgeDistance> within = tree.within(p, maxDistanceSqr, strict);
+	std::sort(within.begin(), within.end(), distanceLess);
+	CHECK(sameDistances(within, expected));
+}
+
+
+
+TEST(EdgeTree_MatchesBruteForce)
+{
+	std::mt19937 rng(11);
+
+	for ( unsigned i = 0; i < 100; ++i ) {
+		unsigned const n = 3 + rng() % 300;
+		Polygon const polygon = i % 3 == 0 ? test::randomPolygon(rng, n, 1000)
+		                                   : test::randomStar(rng, n, Point(500, 500), 500, i % 3 == 2);
+		EdgeTree const tree(polygon);
+
+		std::uniform_real_distribution<double> coord(-200, 1200), radius(0, 300);
+		for ( unsigned q = 0; q < 50; ++q ) {
+			// Vertices and edge middle points make ties between edges
+			Point p(coord(rng), coord(rng));
+			if ( q % 5 == 0 )
+				p = polygon[rng() % n];
+			else if ( q % 5 == 1 ) {
+				Segment const edge = *polygon.edgeAt(rng() % n);
+				p = edge.p1 + 0.5 * edge.toVector();
+			}
+
+			double const r = radius(rng);
+			double const maxDistanceSqr = q % 2 == 0 ? DBL_MAX : r * r;
+			checkQueries(tree, polygon, p, maxDistanceSqr, false);
+			checkQueries(tree, polygon, p, maxDistanceSqr, true);
+		}
+	}
+}
+
+
+
+// Polygon builds its tree after several queries, which must give the same results
+TEST(EdgeTree_PolygonNearestEdge)
+{
+	std::mt19937 rng(12);
+	Polygon const polygon = test::randomStar(rng, 500, Point(0, 0), 1000);
+
+	std::uniform_real_distribution<double> coord(-1200, 1200);
+	for ( unsigned q = 0; q < 100; ++q ) {
+		Point const p(coord(rng), coord(rng));
+		for ( bool strict : {false, true} ) {
+			EdgeDistance const expected = nearestEdge(p, polygon, DBL_MAX, strict);
+			EdgeDistance const found = polygon.nearestEdge(p, DBL_MAX, strict);
+			CHECK(found.edge == expected.edge && found.distanceSqr == expected.distanceSqr);
+		}
+	}
+}
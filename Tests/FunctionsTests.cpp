@@ -0,0 +1,101 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/EdgeIntersections.h"
+#include "../Poly/Functions.h"
+
+#include <random>
+
+using namespace poly;
+
+
+
+static Polygon polygon(std::vector<double> const &coords)
+{
+	std::vector<Point> vertices;
+	for ( size_t i = 0; i + 1 < coords.size(); i += 2 )
+		vertices.push_back(Point(coords[i], coords[i+1]));
+	return Polygon(std::move(vertices));
+}
+
+
+
+/// Staircase from (size, 0) to (0, size) with steps of 2, shifted by (d, d), closed through
+/// corner (c, c).
+//
+static Polygon staircase(double size, double d, double c)
+{
+	std::vector<Point> vertices;
+	for ( double k = 0; k < size; k += 2 ) {
+		vertices.push_back(Point(size - k + d, k + d));
+		vertices.push_back(Point(size - k + d, k + 2 + d));
+	}
+	vertices.push_back(Point(d, size + d));
+	vertices.push_back(Point(c, c));
+	return Polygon(std::move(vertices));
+}
+
+
+
+/// Test answer of intersects() and the layer deciding it, for both orders of operands.
+//
+static void checkIntersects(Polygon const &p1, Polygon const &p2, bool expected,
+                            IntersectionTestLayer expectedLayer)
+{
+	IntersectionTestLayer layer;
+	CHECK(intersects(p1, p2, &layer) == expected);
+	CHECK(layer == expectedLayer);
+	CHECK(intersects(p2, p1, &layer) == expected);
+	CHECK(layer == expectedLayer);
+}
+
+
+
+TEST(Intersects_Layers)
+{
+	Polygon const square = polygon({0,0, 100,0, 100,100, 0,100});
+
+	// Disjoint bounding boxes
+	checkIntersects(square, polygon({200,0, 300,0, 300,100, 200,100}), false, IsectLayer_BoundingBox);
+	checkIntersects(square, Polygon(), false, IsectLayer_BoundingBox);
+
+	// Nested: no edge of the outer polygon reaches bounding box of the inner one
+	checkIntersects(square, polygon({40,40, 60,40, 60,60, 40,60}), false, IsectLayer_EdgeBoxes);
+
+	// Interleaved staircases: edges reach the common box, but chains of consecutive edges in
+	// one direction are single edges with disjoint boxes
+	checkIntersects(staircase(20, 0, 0), staircase(20, 1, 21), false, IsectLayer_MonotoneChains);
+
+	// Box of the long edge overlaps the other polygon
+	Polygon const triangle = polygon({0,0, 10,0, 0,10});
+	checkIntersects(triangle, polygon({10,10, 10,4, 4,10}), false, IsectLayer_Exact);
+
+	// Crossing, touching at a vertex and nested polygon touching the outer one
+	checkIntersects(square, polygon({50,50, 150,50, 150,150, 50,150}), true, IsectLayer_Exact);
+	checkIntersects(square, polygon({100,100, 200,100, 200,200, 100,200}), true, IsectLayer_Exact);
+	checkIntersects(square, polygon({0,40, 60,40, 60,60}), true, IsectLayer_Exact);
+}
+
+
+
+TEST(Intersects_MatchesBruteForce)
+{
+	std::mt19937 rng(15);
+
+	unsigned found = 0;
+	for ( unsigned i = 0; i < 2000; ++i ) {
+		double const radius = i % 2 == 0 ? 30 : 1000;
+		Polygon const p1 = test::randomStar(rng, 5 + rng() % 30, Point(0, 0), radius, i % 4 < 2);
+		Polygon const p2 = test::randomStar(rng, 5 + rng() % 30,
+		                                    Point(rng() % unsigned(3 * radius), rng() % unsigned(3 * radius)),
+		                                    radius, i % 4 < 2);
+
+		bool const expected = ! findEdgeIntersections_BruteForce(p1, p2).empty();
+		IntersectionTestLayer layer;
+		CHECK(intersects(p1, p2, &layer) == expected);
+		CHECK(! expected || layer == IsectLayer_Exact);
+		if ( expected )
+			++found;
+	}
+	CHECK(found > 200 && found < 1800);
+}
@@ -0,0 +1,127 @@
+#include "Test.h"
+
+#include "../Poly/Overlay.h"
+
+#include <stdexcept>
+
+using namespace poly;
+
+
+
+static Polygon square(double x, double y, double size)
+{
+	return Polygon(std::vector<Point>{Point(x, y), Point(x + size, y), Point(x + size, y + size),
+	                                  Point(x, y + size)});
+}
+
+
+
+template <typename Exception>
+static bool isError(std::exception_ptr const &error)
+{
+	try {
+		std::rethrow_exception(error);
+	}
+	catch ( Exception const & ) {
+		return true;
+	}
+	catch ( ... ) {
+	}
+	return false;
+}
+
+
+
+// The first throwing pair aborted the whole overlay
+TEST(Overlay_FailedPairsIsolated)
+{
+	unsigned const n = 40;
+	std::vector<Polygon> a, b;
+	for ( unsigned i = 0; i < n; ++i ) {
+		double const x = 100 * i;
+		a.push_back(square(x, 0, 10));
+		b.push_back(square(x + 10, 0, 10));     // touching by edge
+		b.push_back(square(x + 2, 2, 3));       // inside, difference has a hole
+		b.push_back(square(x + 5, 5, 10));      // crossing
+	}
+	// Prepared operand with all of b inside or touching
+	a.push_back(square(-50, -50, 100 * n + 100));
+
+	std::vector<Polygon const *> layerA, layerB;
+	for ( Polygon const &p : a )
+		layerA.push_back(&p);
+	for ( Polygon const &p : b )
+		layerB.push_back(&p);
+
+	for ( unsigned threads : {1u, 4u} ) {
+		std::vector<OverlayResult> const results =
+			overlay(layerA, layerB, BoolOp_Intersect | BoolOp_Subtract12, threads);
+		CHECK(results.size() == 6 * n);
+
+		unsigned numCrossing = 0;
+		for ( OverlayResult const &r : results ) {
+			if ( r.a == n ) {
+				CHECK(r.error && isError<std::range_error>(r.error));
+				continue;
+			}
+			switch ( r.b % 3 ) {
+			case 0: CHECK(r.error && isError<std::domain_error>(r.error)); break;
+			case 1: CHECK(r.error && isError<std::range_error>(r.error)); break;
+			case 2:
+				CHECK(! r.error);
+				CHECK(r.results.intersection.size() == 1 && r.results.difference12.size() == 1);
+				++numCrossing;
+				break;
+			}
+			CHECK(r.error || r.b / 3 == r.a);
+		}
+		CHECK(numCrossing == n);
+	}
+}
+
+
+
+TEST(Overlay_AddDisjointWithOverlappingBoxes)
+{
+	Polygon const l(std::vector<Point>{Point(0,0), Point(10,0), Point(10,2), Point(2,2), Point(2,10),
+	                                   Point(0,10)});
+	Polygon const s = square(5, 5, 4);
+
+	std::vector<OverlayResult> const results = overlay({&l}, {&s}, BoolOp_Add | BoolOp_Intersect, 1);
+	CHECK(results.size() == 1);
+	CHECK(! results.front().error);
+	CHECK(results.front().results.sum.size() == 2);
+}
+
+
+
+// Exception of visitor stops overlay and is passed to caller
+TEST(Overlay_VisitorThrows)
+{
+	std::vector<Polygon> a, b;
+	for ( unsigned i = 0; i < 100; ++i ) {
+		a.push_back(square(20 * i, 0, 10));
+		b.push_back(square(20 * i + 5, 5, 10));
+	}
+	std::vector<Polygon const *> layerA, layerB;
+	for ( unsigned i = 0; i < a.size(); ++i ) {
+		layerA.push_back(&a[i]);
+		layerB.push_back(&b[i]);
+	}
+
+	for ( unsigned threads : {1u, 4u} ) {
+		unsigned visited = 0;
+		bool thrown = false;
+		try {
+			overlay(layerA, layerB, BoolOp_Intersect, [&](OverlayResult &&) {
+				if ( ++visited == 20 )
+					throw std::logic_error("visitor");
+			}, threads);
+		}
+		catch ( std::logic_error const & ) {
+			thrown = true;
+		}
+		CHECK(thrown);
+		CHECK(visited == 20);
+	}
+}
@@ -0,0 +1,60 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/Functions.h"
+#include "../Poly/PointClassifier.h"
+#include "../Poly/PointGrid.h"
+
+#include <random>
+
+using namespace poly;
+
+
+
+/// Test classifier against locatePoint() at vertices, edge middle points and random points.
+//
+static void checkClassifier(PointClassifier const &classifier, Polygon const &polygon,
+                            std::mt19937 &rng, unsigned numRandom)
+{
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it ) {
+		Segment const edge = *it;
+		CHECK(classifier.classify(edge.p1) == PointLoc_Boundary);
+		Point const middle = edge.p1 + 0.5 * edge.toVector();
+		CHECK(classifier.classify(middle) == locatePoint(middle, polygon));
+	}
+
+	Rect const box = polygon.boundingBox();
+	std::uniform_real_distribution<double> x(box.pMin.x - 1, box.pMax.x + 1);
+	std::uniform_real_distribution<double> y(box.pMin.y - 1, box.pMax.y + 1);
+	for ( unsigned i = 0; i < numRandom; ++i ) {
+		Point const p(x(rng), y(rng));
+		CHECK(classifier.classify(p) == locatePoint(p, polygon));
+	}
+}
+
+
+
+TEST(PointClassifier_MatchesLocatePoint)
+{
+	std::mt19937 rng(7);
+
+	for ( unsigned i = 0; i < 200; ++i ) {
+		Polygon const polygon = test::randomStar(rng, 3 + rng() % 100, Point(0, 0), 1000, i % 2 != 0);
+		checkClassifier(PointClassifier(polygon), polygon, rng, 100);
+	}
+}
+
+
+
+// Edges of star polygon span about half of its height, and were copied into as many bands
+TEST(PointClassifier_LongEdgesMemory)
+{
+	std::mt19937 rng(8);
+	unsigned const n = 20000;
+	Polygon const polygon = test::randomStar(rng, n, Point(0, 0), 1000000);
+
+	PointClassifier const classifier(polygon);
+	CHECK(classifier.numStoredEdges() <= 6 * size_t(n));
+
+	checkClassifier(classifier, polygon, rng, 1000);
+}
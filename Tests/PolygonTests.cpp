@@ -0,0 +1,128 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/Functions.h"
+#include "../Poly/MultiRingPolygon.h"
+#include "../Poly/PointGrid.h"
+#include "../Poly/Polygon.h"
+
+#include <random>
+
+using namespace poly;
+
+
+
+// Edge tree built before reversal was kept, with edge indices of the old order
+TEST(Polygon_MakeCcwDropsEdgeTree)
+{
+	std::mt19937 rng(1);
+	Polygon p = test::randomStar(rng, 200, Point(0, 0), 1000);
+	if ( p.isCcw() )
+		p = test::reversed(p);
+
+	std::uniform_real_distribution<double> coord(-1000, 1000);
+	for ( unsigned i = 0; i < 100; ++i )
+		p.nearestEdge(Point(coord(rng), coord(rng)));
+
+	p.makeCcw();
+	Polygon const fresh(std::vector<Point>(p.begin(), p.end()));
+
+	for ( unsigned i = 0; i < 100; ++i ) {
+		Point const q(coord(rng), coord(rng));
+		CHECK(p.nearestEdge(q).edge == fresh.nearestEdge(q).edge);
+	}
+}
+
+
+
+/// Test Polygon::locate() against locatePoint() at vertices, edge middle points and random
+/// points. The number of queries is enough for the polygon to build its grid.
+//
+static void checkLocate(Polygon const &polygon, std::mt19937 &rng)
+{
+	for ( auto it = polygon.edgeBegin(); it != polygon.edgeEnd(); ++it ) {
+		Segment const edge = *it;
+		CHECK(polygon.locate(edge.p1) == PointLoc_Boundary);
+		Point const middle = edge.p1 + 0.5 * edge.toVector();
+		CHECK(polygon.locate(middle) == locatePoint(middle, polygon));
+	}
+
+	Rect const box = polygon.boundingBox();
+	std::uniform_real_distribution<double> x(box.pMin.x - 1, box.pMax.x + 1);
+	std::uniform_real_distribution<double> y(box.pMin.y - 1, box.pMax.y + 1);
+	for ( unsigned i = 0; i < 300; ++i ) {
+		Point const p(x(rng), y(rng));
+		CHECK(polygon.locate(p) == locatePoint(p, polygon));
+	}
+}
+
+
+
+// Grid lists edges in cells along them; self-intersecting polygons of random vertices have
+// long diagonal edges
+TEST(Polygon_LocateMatchesLocatePoint)
+{
+	std::mt19937 rng(9);
+	std::uniform_real_distribution<double> shift(-500, 500);
+
+	for ( unsigned i = 0; i < 100; ++i ) {
+		unsigned const n = 64 + rng() % 300;
+		Polygon p = i % 3 == 0 ? test::randomPolygon(rng, n, 1000)
+		                       : test::randomStar(rng, n, Point(0, 0), 1000, i % 3 == 2);
+		checkLocate(p, rng);
+
+		p.translate(Vector(shift(rng), shift(rng)));
+		checkLocate(p, rng);
+
+		for ( unsigned k = 0; k < 5; ++k ) {
+			Rect const box = p.boundingBox();
+			std::uniform_real_distribution<double> x(box.pMin.x, box.pMax.x), y(box.pMin.y, box.pMax.y);
+			p.setVertex(p.begin() + rng() % p.numVertices(), Point(x(rng), y(rng)));
+			checkLocate(p, rng);
+		}
+	}
+}
+
+
+
+// Thin polygons make grids of one row or column
+TEST(PointGrid_DegenerateBox)
+{
+	std::mt19937 rng(10);
+	std::uniform_real_distribution<double> coord(0, 1000);
+
+	for ( unsigned i = 0; i < 20; ++i ) {
+		std::vector<Point> vertices;
+		for ( unsigned k = 0; k < 100; ++k )
+			vertices.push_back(i % 2 == 0 ? Point(coord(rng), 5) : Point(5, coord(rng)));
+		Polygon const p(std::move(vertices));
+
+		PointGrid const grid(p);
+		for ( Point const &v : p )
+			CHECK(grid.locate(v) == PointLoc_Boundary);
+		for ( unsigned k = 0; k < 100; ++k ) {
+			Point const onLine = i % 2 == 0 ? Point(coord(rng), 5) : Point(5, coord(rng));
+			Point const q(coord(rng), coord(rng));
+			CHECK(grid.locate(onLine) == locatePoint(onLine, p));
+			CHECK(grid.locate(q) == locatePoint(q, p));
+		}
+	}
+}
+
+
+
+// Moved-from polygon was left without ring offsets, and numRings() wrapped around
+TEST(MultiRingPolygon_MovedFromIsEmpty)
+{
+	MultiRingPolygon p(Polygon(std::vector<Point>{Point(0,0), Point(10,0), Point(10,10), Point(0,10)}));
+	p.addHole(Polygon(std::vector<Point>{Point(2,2), Point(5,2), Point(5,5), Point(2,5)}));
+
+	MultiRingPolygon q(std::move(p));
+	CHECK(q.numRings() == 2 && q.numHoles() == 1);
+	CHECK(p.empty() && p.numRings() == 0 && p.numHoles() == 0);
+
+	MultiRingPolygon r;
+	r = std::move(q);
+	CHECK(r.numRings() == 2);
+	CHECK(q.empty() && q.numRings() == 0);
+}
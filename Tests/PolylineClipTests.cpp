@@ -0,0 +1,140 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/PolylineClip.h"
+
+#include <cmath>
+#include <random>
+
+using namespace poly;
+
+
+
+static double length(Polyline const &polyline)
+{
+	double rv = 0;
+	for ( size_t i = 1; i < polyline.size(); ++i )
+		rv += std::hypot(polyline[i].x - polyline[i-1].x, polyline[i].y - polyline[i-1].y);
+	return rv;
+}
+
+
+
+/// Test that pieces lie on their side of polygon by sampling their middle points.
+/*!
+ * Segments too short for the middle point to be classified reliably are skipped.
+ */
+static void checkSide(std::vector<Polyline> const &pieces, Polygon const &polygon,
+                      PointLocation wrongSide)
+{
+	for ( Polyline const &piece : pieces ) {
+		CHECK(piece.size() >= 2);
+		for ( size_t i = 1; i < piece.size(); ++i ) {
+			if ( std::hypot(piece[i].x - piece[i-1].x, piece[i].y - piece[i-1].y) < 1e-3 )
+				continue;
+			Point const middle = piece[i-1] + 0.5 * (piece[i] - piece[i-1]);
+			CHECK(polygon.locate(middle) != wrongSide);
+		}
+	}
+}
+
+
+
+/// Test clipping by sampling, and that pieces add up to polylines.
+//
+static void checkClips(std::vector<Polyline> const &polylines, Polygon const &polygon,
+                       size_t &insidePieces, size_t &outsidePieces)
+{
+	std::vector<PolylineClip> const clips = clipPolylines(polylines, polygon, 2);
+	CHECK(clips.size() == polylines.size());
+	for ( size_t k = 0; k < clips.size() && k < polylines.size(); ++k ) {
+		checkSide(clips[k].inside, polygon, PointLoc_Outside);
+		checkSide(clips[k].outside, polygon, PointLoc_Inside);
+		insidePieces += clips[k].inside.size();
+		outsidePieces += clips[k].outside.size();
+
+		double clipped = 0;
+		for ( Polyline const &piece : clips[k].inside )
+			clipped += length(piece);
+		for ( Polyline const &piece : clips[k].outside )
+			clipped += length(piece);
+		CHECK(std::abs(clipped - length(polylines[k])) <= 1e-9 * length(polylines[k]));
+	}
+}
+
+
+
+TEST(PolylineClip_MatchesSampling)
+{
+	std::mt19937 rng(6);
+	std::uniform_real_distribution<double> coord(-150, 150);
+
+	size_t insidePieces = 0, outsidePieces = 0;
+	for ( unsigned i = 0; i < 200; ++i ) {
+		Polygon const polygon = test::randomStar(rng, 5 + rng() % 60, Point(0, 0), 100, i % 2 != 0);
+		if ( ! polygon.isSimple() )
+			continue;
+
+		std::vector<Polyline> polylines(20);
+		for ( Polyline &polyline : polylines ) {
+			unsigned const n = 2 + rng() % 20;
+			for ( unsigned k = 0; k < n; ++k )
+				polyline.push_back(Point(coord(rng), coord(rng)));
+		}
+
+		checkClips(polylines, polygon, insidePieces, outsidePieces);
+	}
+
+	CHECK(insidePieces > 1000 && outsidePieces > 1000);
+}
+
+
+
+// Pieces are classified only after touching the boundary, otherwise sides alternate at crossings
+TEST(PolylineClip_ThroughVertices)
+{
+	std::mt19937 rng(9);
+
+	size_t insidePieces = 0, outsidePieces = 0;
+	for ( unsigned i = 0; i < 200; ++i ) {
+		Polygon const polygon = test::randomStar(rng, 5 + rng() % 60, Point(0, 0), 100, i % 2 != 0);
+		if ( ! polygon.isSimple() )
+			continue;
+
+		// Vertices of polygon and points of integer grid, so that polylines go along edges and
+		// through vertices
+		std::vector<Polyline> polylines(20);
+		for ( Polyline &polyline : polylines ) {
+			unsigned const n = 2 + rng() % 20;
+			for ( unsigned k = 0; k < n; ++k ) {
+				if ( rng() % 2 == 0 )
+					polyline.push_back(polygon[rng() % polygon.numVertices()]);
+				else
+					polyline.push_back(Point(double(rng() % 300) - 150, double(rng() % 300) - 150));
+			}
+		}
+
+		checkClips(polylines, polygon, insidePieces, outsidePieces);
+	}
+
+	CHECK(insidePieces > 1000 && outsidePieces > 1000);
+}
+
+
+
+TEST(PolylineClip_LargePolygon)
+{
+	std::mt19937 rng(10);
+	Polygon const polygon = test::randomStar(rng, 20000, Point(0, 0), 1000000);
+	std::uniform_real_distribution<double> coord(-1200000, 1200000);
+
+	std::vector<Polyline> polylines(10);
+	for ( Polyline &polyline : polylines ) {
+		for ( unsigned k = 0; k < 5; ++k )
+			polyline.push_back(Point(coord(rng), coord(rng)));
+	}
+
+	size_t insidePieces = 0, outsidePieces = 0;
+	checkClips(polylines, polygon, insidePieces, outsidePieces);
+	CHECK(insidePieces > 1000 && outsidePieces > 1000);
+}
@@ -0,0 +1,242 @@
+#include "Test.h"
+
+#include "../Poly/Kernel.h"
+#include "../Poly/Predicates.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+using namespace poly;
+
+
+
+/// Add sign * x * y to number given by coefficients of powers of 2^16.
+/*! Digits of 16 bits keep products and their sums far from overflow for any int64 values.
+ */
+static void addProduct(int64_t x, int64_t y, int sign, int64_t coefs[7])
+{
+	if ( (x < 0) != (y < 0) )
+		sign = -sign;
+	uint64_t const ux = x < 0 ? 0 - uint64_t(x) : uint64_t(x);
+	uint64_t const uy = y < 0 ? 0 - uint64_t(y) : uint64_t(y);
+
+	for ( int i = 0; i < 4; ++i ) {
+		for ( int j = 0; j < 4; ++j ) {
+			int64_t const dx = int64_t((ux >> (16 * i)) & 0xFFFF), dy = int64_t((uy >> (16 * j)) & 0xFFFF);
+			coefs[i + j] += sign * dx * dy;
+		}
+	}
+}
+
+
+
+/// Sign of a*b - c*d by schoolbook multiplication, independent of predicates.
+//
+static int referenceSign(int64_t a, int64_t b, int64_t c, int64_t d)
+{
+	int64_t coefs[7] = {0, 0, 0, 0, 0, 0, 0};
+	addProduct(a, b, 1, coefs);
+	addProduct(c, d, -1, coefs);
+
+	// Carry, so that all coefficients but the highest are digits in [0, 2^16)
+	for ( int i = 0; i < 6; ++i ) {
+		int64_t carry = coefs[i] / 65536;
+		if ( coefs[i] - carry * 65536 < 0 )
+			--carry;
+		coefs[i] -= carry * 65536;
+		coefs[i + 1] += carry;
+	}
+
+	if ( coefs[6] != 0 )
+		return coefs[6] > 0 ? 1 : -1;
+	for ( int i = 5; i >= 0; --i )
+		if ( coefs[i] != 0 )
+			return 1;
+	return 0;
+}
+
+
+
+TEST(Predicates_ReferenceSign)
+{
+	CHECK(referenceSign(3, 4, 2, 6) == 0);
+	CHECK(referenceSign(3, 4, 2, 5) == 1);
+	CHECK(referenceSign(-3, 4, 2, 5) == -1);
+	CHECK(referenceSign(int64_t(1) << 40, int64_t(1) << 40, int64_t(1) << 41, int64_t(1) << 39) == 0);
+	CHECK(referenceSign(int64_t(1) << 40, (int64_t(1) << 40) + 1, int64_t(1) << 41, int64_t(1) << 39) == 1);
+}
+
+
+
+TEST(Predicates_ProductDiffSignExtremes)
+{
+	int64_t const Max = std::numeric_limits<int64_t>::max(), Min = std::numeric_limits<int64_t>::min();
+	int64_t const Big = int64_t(1) << 62;
+
+	std::vector<int64_t> values = {0, 1, -1, 2, -2, Max, Min, Max - 1, Min + 1, Big, -Big,
+	                               Big - 1, Big + 1, 1 - Big, -1 - Big, 3037000499, -3037000500};
+	for ( int64_t v : values )
+		CHECK(predicates::productDiffSign(v, v, v, v) == 0);
+	for ( int64_t a : values )
+		for ( int64_t b : values )
+			for ( int64_t c : values )
+				for ( int64_t d : {int64_t(1), Big - 1, Min, Max} )
+					CHECK(predicates::productDiffSign(a, b, c, d) == referenceSign(a, b, c, d));
+
+	// Equal and nearly equal products of different factors near 2^62: a*b - c*d = s*k*m*delta
+	std::mt19937_64 rng(16);
+	for ( unsigned i = 0; i < 10000; ++i ) {
+		int64_t const k = int64_t(rng() % (uint64_t(1) << 31)) + 1;
+		int64_t const m = int64_t(rng() % (uint64_t(1) << 31)) + 1;
+		int64_t const n = int64_t(rng() % (uint64_t(1) << 30)) + 1;
+		int64_t const s = i % 2 == 0 ? 1 : -1;
+		for ( int64_t delta : {-2, -1, 0, 1, 2} ) {
+			int64_t const a = s * k * m, b = n + delta, c = k * n, d = s * m;
+			CHECK(predicates::productDiffSign(a, b, c, d) == referenceSign(a, b, c, d));
+			CHECK(predicates::productDiffSign(a, b, c, d) == int(s) * (delta == 0 ? 0 : delta > 0 ? 1 : -1));
+		}
+	}
+}
+
+
+
+/// Exact integer of double in [-2, 2), in units of 2^-52.
+//
+static int64_t scaled(double x)
+{
+	return int64_t(std::ldexp(x, 52));
+}
+
+
+
+/// Test if coordinates are multiples of 2^-52 in [-2, 2), so that scaled() is exact.
+//
+static bool onScaledGrid(Point const &p)
+{
+	for ( double x : {p.x, p.y} ) {
+		double const u = std::ldexp(x, 52);
+		if ( ! (std::fabs(x) < 2) || u != std::floor(u) )
+			return false;
+	}
+	return true;
+}
+
+
+
+/// Test crossSign() and crossSignExact() against reference for coordinates on scaled grid.
+//
+static void checkCrossSign(Point const &a, Point const &b, Point const &c, Point const &d)
+{
+	CHECK(onScaledGrid(a) && onScaledGrid(b) && onScaledGrid(c) && onScaledGrid(d));
+	int const expected = referenceSign(scaled(b.x) - scaled(a.x), scaled(d.y) - scaled(c.y),
+	                                   scaled(b.y) - scaled(a.y), scaled(d.x) - scaled(c.x));
+	CHECK(predicates::crossSign(a, b, c, d) == expected);
+	CHECK(predicates::detail::crossSignExact(a, b, c, d) == expected);
+}
+
+
+
+static double nudge(double x, int ulps)
+{
+	for ( ; ulps > 0; --ulps )
+		x = std::nextafter(x, 4.0);
+	for ( ; ulps < 0; ++ulps )
+		x = std::nextafter(x, -4.0);
+	return x;
+}
+
+
+
+// Points a few ulps off a line, where the floating-point filter cannot decide
+TEST(Predicates_CrossSignNearlyCollinear)
+{
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<double> coord(1, 2), param(-0.5, 1.5);
+
+	unsigned zeros = 0;
+	for ( unsigned i = 0; i < 20000; ++i ) {
+		// Coordinates of both signs, on the grid of 2^-52 while at least 1 by absolute value
+		double const sx = i % 2 == 0 ? 1 : -1, sy = i % 4 < 2 ? 1 : -1;
+		Point const a(sx * coord(rng), sy * coord(rng));
+		Point b(sx * coord(rng), sy * coord(rng));
+		Point c;
+		if ( i % 8 < 4 ) {
+			double const t = param(rng);
+			c = Point(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+		}
+		else {
+			// Exactly collinear before nudging: steps along a short direction of grid units
+			double const u = std::ldexp(1.0, -30);
+			double const px = double(rng() % 1000) * u, py = double(rng() % 1000) * u, m = rng() % 1000;
+			b = Point(a.x - sx * px, a.y - sy * py);
+			c = Point(a.x - sx * m * px, a.y - sy * m * py);
+		}
+		c = Point(nudge(c.x, int(rng() % 7) - 3), nudge(c.y, int(rng() % 7) - 3));
+		if ( ! onScaledGrid(b) )
+			continue;
+		if ( ! onScaledGrid(c) )
+			continue;
+
+		checkCrossSign(a, b, a, c);
+		checkCrossSign(a, c, a, b);
+		if ( predicates::orientSign(a, b, c) == 0 )
+			++zeros;
+
+		// Nearly parallel segments not sharing endpoints
+		Point const d(nudge(c.x + (b.x - a.x) / 4, int(rng() % 5) - 2),
+		              nudge(c.y + (b.y - a.y) / 4, int(rng() % 5) - 2));
+		if ( onScaledGrid(d) )
+			checkCrossSign(a, b, c, d);
+	}
+	CHECK(zeros > 100);
+
+	// Collinear and off by one ulp, with coordinates of different magnitudes
+	checkCrossSign(Point(0, 0), Point(1, 1), Point(0, 0), Point(nudge(1.5, 1), 1.5));
+	checkCrossSign(Point(0, 0), Point(1, 1), Point(0, 0), Point(0.5, 0.5));
+	checkCrossSign(Point(1.5, 1.5), Point(std::ldexp(1, -40), std::ldexp(1, -40)),
+	               Point(0, 0), Point(1, 1));
+}
+
+
+
+/// Test integral CoordTraits against reference.
+//
+template <typename T>
+static void checkIntegralCrossSign(BasicPoint<T> const &a, BasicPoint<T> const &b, BasicPoint<T> const &c)
+{
+	int const expected = referenceSign(int64_t(b.x) - int64_t(a.x), int64_t(c.y) - int64_t(a.y),
+	                                   int64_t(b.y) - int64_t(a.y), int64_t(c.x) - int64_t(a.x));
+	CHECK(CoordTraits<T>::crossSign(a, b, a, c) == expected);
+	CHECK(orientation(a, b, c) == (expected < 0 ? Left : expected > 0 ? Right : Collinear));
+}
+
+
+
+TEST(Predicates_IntegralCoordTraits)
+{
+	CHECK(CoordTraits<int32_t>::ExactInDouble);
+	CHECK(! CoordTraits<int64_t>::ExactInDouble);
+
+	// Coordinates near the 2^62 limit, collinear and off by one
+	int64_t const Limit = (int64_t(1) << 62) - 1;
+	std::mt19937_64 rng(18);
+	for ( unsigned i = 0; i < 10000; ++i ) {
+		int64_t const k = int64_t(rng() % 1000) + 1;
+		int64_t const dx = int64_t(rng() % uint64_t(Limit / k)), dy = int64_t(rng() % uint64_t(Limit / k));
+		BasicPoint<int64_t> const a(i % 2 == 0 ? -Limit : Limit - k * dx, -Limit);
+		BasicPoint<int64_t> const b(a.x + dx, a.y + dy);
+		BasicPoint<int64_t> c(a.x + k * dx, a.y + k * dy);
+		c.x += int64_t(rng() % 3) - 1;
+		checkIntegralCrossSign(a, b, c);
+	}
+
+	int32_t const Max32 = std::numeric_limits<int32_t>::max(), Min32 = std::numeric_limits<int32_t>::min();
+	checkIntegralCrossSign(BasicPoint<int32_t>(Min32, Min32), BasicPoint<int32_t>(Max32, Max32),
+	                       BasicPoint<int32_t>(0, 0));
+	checkIntegralCrossSign(BasicPoint<int32_t>(Min32, Min32), BasicPoint<int32_t>(Max32, Max32),
+	                       BasicPoint<int32_t>(0, 1));
+	checkIntegralCrossSign(BasicPoint<int32_t>(Min32, Max32), BasicPoint<int32_t>(Max32, Min32),
+	                       BasicPoint<int32_t>(Max32, Max32 - 1));
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../Poly/Polygon.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+
+
+namespace test {
+
+
+
+/// Random star-shaped polygon with integer coordinates.
+/*!
+ * Vertices go around the center at equal angles, at random distances from radius * 0.3 to
+ * radius. With axisAligned, some edges are made vertical or horizontal. The polygon is not
+ * necessarily simple: rounding can make edges touch.
+ */
+inline poly::Polygon randomStar(std::mt19937 &rng, unsigned n, poly::Point const &center,
+                                double radius, bool axisAligned = false)
+{
+	double const Pi = 3.14159265358979323846;
+	std::uniform_real_distribution<double> distance(0.3 * radius, radius);
+
+	std::vector<poly::Point> vertices;
+	for ( unsigned i = 0; i < n; ++i ) {
+		double const a = 2 * Pi * i / n;
+		double const r = distance(rng);
+		poly::Point p(std::floor(center.x + r * std::cos(a) + 0.5),
+		              std::floor(center.y + r * std::sin(a) + 0.5));
+		if ( axisAligned && ! vertices.empty() ) {
+			if ( rng() % 3 == 0 )
+				p.x = vertices.back().x;
+			if ( rng() % 5 == 0 )
+				p.y = vertices.back().y;
+		}
+		if ( vertices.empty() || ! (vertices.back() == p) )
+			vertices.push_back(p);
+	}
+	if ( vertices.size() > 1 && vertices.front() == vertices.back() )
+		vertices.pop_back();
+
+	return poly::Polygon(std::move(vertices));
+}
+
+
+
+/// Polygon of random vertices in square [0, size)^2, usually self-intersecting.
+//
+inline poly::Polygon randomPolygon(std::mt19937 &rng, unsigned n, double size)
+{
+	std::uniform_real_distribution<double> coord(0, size);
+
+	std::vector<poly::Point> vertices;
+	for ( unsigned i = 0; i < n; ++i )
+		vertices.push_back(poly::Point(coord(rng), coord(rng)));
+
+	return poly::Polygon(std::move(vertices));
+}
+
+
+
+/// Convex hull of n random points with integer coordinates in disk of given radius.
+/*!
+ * Collinear vertices are dropped, so the result is strictly convex if it has 3 vertices or
+ * more. Counterclockwise in repo's sense, that is with positive signed area.
+ */
+inline poly::Polygon randomConvex(std::mt19937 &rng, unsigned n, poly::Point const &center,
+                                  double radius)
+{
+	double const Pi = 3.14159265358979323846;
+	std::uniform_real_distribution<double> angle(0, 2 * Pi), distance(0, 1);
+
+	std::vector<poly::Point> points;
+	for ( unsigned i = 0; i < n; ++i ) {
+		double const a = angle(rng);
+		double const r = radius * std::sqrt(distance(rng));
+		points.push_back(poly::Point(std::floor(center.x + r * std::cos(a) + 0.5),
+		                             std::floor(center.y + r * std::sin(a) + 0.5)));
+	}
+	std::sort(points.begin(), points.end(), [](poly::Point const &a, poly::Point const &b) {
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	});
+
+	// Monotone chain: one half of hull on each pass, the second over reversed points
+	auto const cross = [](poly::Point const &o, poly::Point const &a, poly::Point const &b) {
+		return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+	};
+	std::vector<poly::Point> hull;
+	for ( int pass = 0; pass < 2; ++pass ) {
+		size_t const start = hull.size();
+		for ( poly::Point const &p : points ) {
+			while ( hull.size() >= start + 2 && cross(hull[hull.size() - 2], hull.back(), p) >= 0 )
+				hull.pop_back();
+			hull.push_back(p);
+		}
+		hull.pop_back();
+		std::reverse(points.begin(), points.end());
+	}
+
+	return poly::Polygon(std::move(hull));
+}
+
+
+
+/// Rectangle with integer corners in square [0, size]^2, not degenerate.
+//
+inline poly::Polygon randomRect(std::mt19937 &rng, unsigned size)
+{
+	unsigned const x1 = rng() % size, y1 = rng() % size;
+	unsigned const x2 = x1 + 1 + rng() % (size - x1), y2 = y1 + 1 + rng() % (size - y1);
+	return poly::Polygon(std::vector<poly::Point>{poly::Point(x1, y1), poly::Point(x2, y1),
+	                                              poly::Point(x2, y2), poly::Point(x1, y2)});
+}
+
+
+
+/// The same polygon with vertices in reverse order.
+//
+inline poly::Polygon reversed(poly::Polygon const &polygon)
+{
+	std::vector<poly::Point> vertices(polygon.begin(), polygon.end());
+	std::reverse(vertices.begin(), vertices.end());
+	return poly::Polygon(std::move(vertices));
+}
+
+
+
+} // namespace test
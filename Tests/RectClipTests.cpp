@@ -0,0 +1,152 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/Boolean.h"
+#include "../Poly/RectClip.h"
+
+#include <cmath>
+#include <random>
+
+using namespace poly;
+
+
+
+static Polygon polygon(std::vector<double> const &coords)
+{
+	std::vector<Point> vertices;
+	for ( size_t i = 0; i + 1 < coords.size(); i += 2 )
+		vertices.push_back(Point(coords[i], coords[i+1]));
+	return Polygon(std::move(vertices));
+}
+
+
+
+static Polygon rectPolygon(Rect const &rect)
+{
+	return Polygon(std::vector<Point>{rect.pMin, Point(rect.pMax.x, rect.pMin.y), rect.pMax,
+	                                  Point(rect.pMin.x, rect.pMax.y)});
+}
+
+
+
+static double area(std::vector<Polygon> const &polygons)
+{
+	double rv = 0;
+	for ( Polygon const &p : polygons )
+		rv += p.signedArea();
+	return rv;
+}
+
+
+
+static bool sameArea(double a1, double a2)
+{
+	return std::fabs(a1 - a2) <= 1e-9 * std::max(1.0, std::fabs(a1));
+}
+
+
+
+/// Test clipping against intersect() with rectangle as polygon, if it supports the operands,
+/// and against expected area otherwise.
+//
+static void checkClip(Polygon const &p, Rect const &rect, double expectedArea, size_t expectedParts)
+{
+	std::vector<Polygon> const clipped = clipToRect(p, rect);
+	CHECK(clipped.size() == expectedParts);
+	CHECK(sameArea(area(clipped), expectedArea));
+	for ( Polygon const &part : clipped ) {
+		CHECK(part.isCcw());
+		Rect const box = part.boundingBox();
+		CHECK(rect.contains(box.pMin) && rect.contains(box.pMax));
+	}
+}
+
+
+
+TEST(RectClip_InsideOutside)
+{
+	Polygon const square = polygon({0,0, 100,0, 100,100, 0,100});
+
+	// Rectangle inside polygon, polygon inside rectangle, and disjoint
+	checkClip(square, Rect(Point(10, 10), Point(20, 30)), 200, 1);
+	checkClip(square, Rect(Point(-10, -10), Point(110, 120)), 10000, 1);
+	checkClip(square, Rect(Point(200, 200), Point(300, 300)), 0, 0);
+	checkClip(square, Rect(Point(10, 150), Point(90, 200)), 0, 0);
+
+	// Overlapping corner, for both windings
+	checkClip(square, Rect(Point(50, 60), Point(150, 160)), 2000, 1);
+	checkClip(test::reversed(square), Rect(Point(50, 60), Point(150, 160)), 2000, 1);
+}
+
+
+
+// Polygon leaves the rectangle and enters it again
+TEST(RectClip_SeveralParts)
+{
+	Polygon const u = polygon({0,0, 30,0, 30,30, 20,30, 20,10, 10,10, 10,30, 0,30});
+	Rect const rect(Point(-5, 20), Point(35, 40));
+	checkClip(u, rect, 200, 2);
+	CHECK(sameArea(area(intersect(u, rectPolygon(rect))), 200));
+
+	// Comb with teeth crossing the rectangle, which leaves middle parts of the teeth only
+	Polygon const comb = polygon({0,0, 70,0, 70,50, 60,50, 60,10, 50,10, 50,50, 40,50, 40,10,
+	                              30,10, 30,50, 20,50, 20,10, 10,10, 10,50, 0,50});
+	Rect const band(Point(-5, 20), Point(75, 30));
+	checkClip(comb, band, 4 * 100, 4);
+	CHECK(sameArea(area(intersect(comb, rectPolygon(band))), 400));
+}
+
+
+
+// Vertices and edges on rectangle boundary, which intersect() does not support
+TEST(RectClip_VerticesOnBorder)
+{
+	Polygon const diamond = polygon({0,10, 10,0, 20,10, 10,20});
+	checkClip(diamond, Rect(Point(0, 0), Point(20, 10)), 100, 1);
+	checkClip(diamond, Rect(Point(0, 0), Point(20, 20)), 200, 1);
+	checkClip(diamond, Rect(Point(10, 0), Point(20, 20)), 100, 1);
+
+	Polygon const square = polygon({0,0, 10,0, 10,10, 0,10});
+	checkClip(square, Rect(Point(0, 0), Point(10, 10)), 100, 1);
+	checkClip(square, Rect(Point(0, 0), Point(10, 5)), 50, 1);
+}
+
+
+
+TEST(RectClip_MatchesIntersect)
+{
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<double> coord(-1100, 1100);
+
+	std::vector<Polygon> polygons;
+	for ( unsigned i = 0; i < 200; ++i ) {
+		Polygon p = test::randomStar(rng, 3 + rng() % 100, Point(0, 0), 1000);
+		if ( p.isSimple() )
+			polygons.push_back(i % 2 == 0 ? std::move(p) : test::reversed(p));
+	}
+	std::vector<Polygon const *> all;
+	for ( Polygon const &p : polygons )
+		all.push_back(&p);
+
+	for ( unsigned i = 0; i < 20; ++i ) {
+		// Non-integer corners avoid touching integer vertices
+		double const x1 = coord(rng) + 0.25, x2 = coord(rng) + 0.25;
+		double const y1 = coord(rng) + 0.25, y2 = coord(rng) + 0.25;
+		Rect const rect(Point(std::min(x1, x2), std::min(y1, y2)), Point(std::max(x1, x2), std::max(y1, y2)));
+		Polygon const rp = rectPolygon(rect);
+
+		std::vector<std::vector<Polygon>> const batch = clipToRect(all, rect);
+		CHECK(batch.size() == polygons.size());
+
+		for ( size_t k = 0; k < polygons.size(); ++k ) {
+			std::vector<Polygon> const expected = intersect(polygons[k], rp);
+			std::vector<Polygon> const clipped = clipToRect(polygons[k], rect);
+			CHECK(clipped.size() == expected.size());
+			CHECK(sameArea(area(clipped), area(expected)));
+
+			CHECK(batch[k].size() == clipped.size());
+			for ( size_t j = 0; j < std::min(batch[k].size(), clipped.size()); ++j )
+				CHECK(std::equal(batch[k][j].begin(), batch[k][j].end(), clipped[j].begin(), clipped[j].end()));
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#include "Test.h"
+
+#include "../Poly/Functions.h"
+#include "../Poly/SegmentBatch.h"
+
+#include <random>
+
+using namespace poly;
+
+
+
+/// Random segment with endpoints on small grid, to get touching and collinear cases.
+//
+static Segment randomSegment(std::mt19937 &rng, unsigned size, double step)
+{
+	Point const p1(step * (rng() % size), step * (rng() % size));
+	Point const p2(step * (rng() % size), step * (rng() % size));
+	return Segment(p1, p2);
+}
+
+
+
+/// Test batch against intersects(Segment, Segment) for all ranges starting at each segment.
+//
+static void checkBatch(std::mt19937 &rng, unsigned size, double step)
+{
+	SegmentBatch batch;
+	std::vector<Segment> segments;
+	unsigned const n = 1 + rng() % 30;
+	for ( unsigned i = 0; i < n; ++i ) {
+		segments.push_back(randomSegment(rng, size, step));
+		batch.add(segments.back());
+	}
+
+	for ( unsigned q = 0; q < 20; ++q ) {
+		Segment const s = randomSegment(rng, size, step);
+
+		for ( unsigned begin = 0; begin <= n; ++begin ) {
+			unsigned expected = begin;
+			while ( expected < n && ! intersects(s, segments[expected]) )
+				++expected;
+			CHECK(batch.findIntersecting(s, begin) == expected);
+		}
+	}
+}
+
+
+
+TEST(SegmentBatch_MatchesIntersects)
+{
+	std::mt19937 rng(4);
+
+	for ( unsigned i = 0; i < 500; ++i ) {
+		checkBatch(rng, 8, 1);
+		checkBatch(rng, 1000, 1);
+		checkBatch(rng, 8, 0.1);   // Inexact coordinates
+	}
+}
@@ -0,0 +1,195 @@
+#include "Test.h"
+#include "RandomShapes.h"
+
+#include "../Poly/SnapBoolean.h"
+
+#include <random>
+#include <stdexcept>
+
+using namespace poly;
+
+
+
+static Polygon polygon(std::vector<double> const &coords)
+{
+	std::vector<Point> vertices;
+	for ( size_t i = 0; i + 1 < coords.size(); i += 2 )
+		vertices.push_back(Point(coords[i], coords[i+1]));
+	return Polygon(std::move(vertices));
+}
+
+
+
+// Hole touching outer contour at a vertex was traced in one pinched contour with it
+TEST(Snapped_HoleTouchingOuterThrows)
+{
+	Polygon const square = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const triangle = polygon({5,0, 7,5, 3,5});
+
+	bool thrown = false;
+	try {
+		evaluateBoolean_Snapped(square, triangle, BoolOp_Subtract12);
+	}
+	catch ( std::range_error const & ) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+
+
+TEST(Snapped_PartsTouchingAtVertex)
+{
+	Polygon const s1 = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const s2 = polygon({10,10, 20,10, 20,20, 10,20});
+
+	BooleanResults const r = evaluateBoolean_Snapped(s1, s2, BoolOp_Add);
+	CHECK(r.sum.size() == 2);
+	for ( Polygon const &p : r.sum ) {
+		CHECK(p.numVertices() == 4);
+		CHECK(p.isCcw());
+	}
+}
+
+
+
+TEST(Snapped_SharedEdgeMerged)
+{
+	Polygon const s1 = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const s2 = polygon({10,0, 20,0, 20,10, 10,10});
+
+	BooleanResults const r = evaluateBoolean_Snapped(s1, s2,
+		BoolOp_Add | BoolOp_Intersect | BoolOp_Subtract12);
+	CHECK(r.sum.size() == 1);
+	CHECK(r.sum.front().numVertices() == 4);
+	CHECK(r.sum.front().isCcw());
+	CHECK(r.sum.front().signedArea() == 200);
+	CHECK(r.intersection.empty());
+	CHECK(r.difference12.size() == 1 && r.difference12.front().signedArea() == 100);
+}
+
+
+
+// Edges overlap in part of their length
+TEST(Snapped_CollinearPartialOverlap)
+{
+	Polygon const s1 = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const s2 = polygon({10,5, 20,5, 20,15, 10,15});
+
+	BooleanResults const r = evaluateBoolean_Snapped(s1, s2, BoolOp_Add | BoolOp_Intersect);
+	CHECK(r.sum.size() == 1);
+	CHECK(r.sum.front().numVertices() == 8);
+	CHECK(r.sum.front().isCcw());
+	CHECK(r.sum.front().signedArea() == 200);
+	CHECK(r.intersection.empty());
+}
+
+
+
+TEST(UnionAllSnapped_BlockOfCells)
+{
+	std::vector<Polygon> cells;
+	for ( int i = 0; i < 3; ++i ) {
+		for ( int j = 0; j < 3; ++j ) {
+			double const x = 10 * i, y = 10 * j;
+			cells.push_back(polygon({x,y, x + 10,y, x + 10,y + 10, x,y + 10}));
+		}
+	}
+
+	std::vector<Polygon const *> all;
+	for ( Polygon const &cell : cells )
+		all.push_back(&cell);
+	std::vector<Polygon> const block = unionAll_Snapped(all);
+	CHECK(block.size() == 1);
+	CHECK(block.front().numVertices() == 4);
+	CHECK(block.front().isCcw());
+	CHECK(block.front().signedArea() == 900);
+
+	// Without the center cell the union has a hole
+	std::vector<Polygon const *> ring = all;
+	ring.erase(ring.begin() + 4);
+	bool thrown = false;
+	try {
+		unionAll_Snapped(ring);
+	}
+	catch ( std::range_error const & ) {
+		thrown = true;
+	}
+	CHECK(thrown);
+}
+
+
+
+TEST(SnappedRings_HoleTouchingOuter)
+{
+	Polygon const square = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const triangle = polygon({5,0, 7,5, 3,5});
+
+	BooleanRingResults const r = evaluateBoolean_SnappedRings(square, triangle, BoolOp_Subtract12);
+	CHECK(r.difference12.size() == 1);
+	if ( r.difference12.size() != 1 )
+		return;
+
+	MultiRingPolygon const &d = r.difference12.front();
+	CHECK(d.numHoles() == 1);
+	CHECK(d.ringSize(0) == 4);
+	CHECK(d.ringSize(1) == 3);
+	CHECK(d.ring(0).isCcw());
+	CHECK(! d.ring(1).isCcw());
+	CHECK(d.area() == 90);
+}
+
+
+
+TEST(SnappedRings_HolesTouchingEachOther)
+{
+	Polygon const square = polygon({0,0, 10,0, 10,10, 0,10});
+	Polygon const bowtie = polygon({2,2, 8,8, 8,2, 2,8});
+
+	BooleanRingResults const r = evaluateBoolean_SnappedRings(square, bowtie, BoolOp_Subtract12);
+	CHECK(r.difference12.size() == 1);
+	if ( r.difference12.size() != 1 )
+		return;
+
+	MultiRingPolygon const &d = r.difference12.front();
+	CHECK(d.numHoles() == 2);
+	for ( unsigned i = 1; i <= d.numHoles(); ++i ) {
+		CHECK(d.ringSize(i) == 3);
+		CHECK(! d.ring(i).isCcw());
+	}
+	CHECK(d.area() == 82);
+}
+
+
+
+static double area(std::vector<MultiRingPolygon> const &polygons)
+{
+	double rv = 0;
+	for ( MultiRingPolygon const &p : polygons )
+		rv += p.area();
+	return rv;
+}
+
+
+
+// All results are made of faces of the same arrangement, so their areas add up exactly, although
+// snapping changes the areas of operands
+TEST(SnappedRings_AreaIdentities)
+{
+	std::mt19937 rng(5);
+
+	for ( unsigned i = 0; i < 500; ++i ) {
+		Polygon const p1 = i % 2 == 0 ? test::randomStar(rng, 5 + rng() % 30, Point(0, 0), 100)
+		                              : test::randomPolygon(rng, 4 + rng() % 10, 100);
+		Polygon const p2 = test::randomStar(rng, 5 + rng() % 30, Point(rng() % 100, rng() % 100), 100,
+		                                    i % 3 == 0);
+
+		BooleanRingResults const r = evaluateBoolean_SnappedRings(p1, p2,
+			BoolOp_Add | BoolOp_Intersect | BoolOp_Subtract12 | BoolOp_Subtract21 | BoolOp_Xor);
+
+		double const sum = area(r.sum), intersection = area(r.intersection);
+		double const difference12 = area(r.difference12), difference21 = area(r.difference21);
+		CHECK(sum == difference12 + intersection + difference21);
+		CHECK(area(r.symDifference) == difference12 + difference21);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+
+
+/*!
+ * Minimal unit test harness
+ *
+ * TEST(Name) defines and registers a test function. CHECK(cond) reports failed condition and
+ * continues, so one run lists all failures. TestMain.cpp runs all registered tests and
+ * returns the number of failed ones.
+ */
+
+namespace test {
+
+
+
+typedef void (*TestFunction)();
+
+struct TestCase {
+	char const *name;
+	TestFunction function;
+};
+
+std::vector<TestCase> & registry();
+
+/// Record failure of current test.
+void fail(char const *file, int line, char const *expr);
+
+struct Registrar {
+	Registrar(char const *name, TestFunction function) { registry().push_back(TestCase{name, function}); }
+};
+
+
+
+} // namespace test
+
+
+
+#define TEST(name)                                                  \
+	static void test_##name();                                      \
+	static test::Registrar registrar_##name(#name, &test_##name);   \
+	static void test_##name()
+
+#define CHECK(cond)                                                 \
+	do {                                                            \
+		if ( ! (cond) )                                             \
+			test::fail(__FILE__, __LINE__, #cond);                  \
+	} while ( false )
@@ -0,0 +1,57 @@
+#include "Test.h"
+
+#include <exception>
+
+
+
+namespace test {
+
+
+
+static unsigned failures;
+
+
+
+std::vector<TestCase> & registry()
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+
+
+void fail(char const *file, int line, char const *expr)
+{
+	std::printf("  %s(%d): CHECK(%s) failed\n", file, line, expr);
+	++failures;
+}
+
+
+
+} // namespace test
+
+
+
+int main()
+{
+	unsigned failedTests = 0;
+
+	for ( test::TestCase const &t : test::registry() ) {
+		std::printf("%s\n", t.name);
+
+		unsigned const failuresBefore = test::failures;
+		try {
+			t.function();
+		}
+		catch ( std::exception const &e ) {
+			std::printf("  exception: %s\n", e.what());
+			++test::failures;
+		}
+
+		if ( test::failures != failuresBefore )
+			++failedTests;
+	}
+
+	std::printf("%u of %u tests failed\n", failedTests, unsigned(test::registry().size()));
+	return int(failedTests);
+}